@@ -0,0 +1,132 @@
+#include "CanvasPool.h"
+
+CanvasPool::CanvasPool(int32_t width, int32_t height)
+    : m_Width(width)
+    , m_Height(height)
+    , m_Limit(4)
+    , m_Users(0)
+    , m_Leases(0)
+    , m_PeakLeases(0)
+{}
+
+CanvasPool* CanvasPool::Get()
+{
+    static CanvasPool pool(2048, 2048);
+    return &pool;
+}
+
+void CanvasPool::Attach()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Users++;
+}
+
+void CanvasPool::Detach()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (--m_Users == 0)
+        FreeIdle(0);
+}
+
+// Deletes idle canvases until no more than keep are left, caller holds the lock..
+void CanvasPool::FreeIdle(size_t keep)
+{
+    for (size_t i = m_Slots.size(); (i > 0) && (m_Slots.size() > keep); i--)
+    {
+        auto& slot = m_Slots[i - 1];
+        if (slot.Leased)
+            continue;
+        delete slot.Canvas;
+        m_Slots.erase(m_Slots.begin() + (i - 1));
+    }
+}
+
+GdiCanvas* CanvasPool::Acquire()
+{
+    auto thread = std::this_thread::get_id();
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true)
+    {
+        // Prefer the canvas this thread used last, then any idle one..
+        Slot_t* pIdle = nullptr;
+        for (auto& slot : m_Slots)
+        {
+            if (slot.Leased)
+                continue;
+            if (slot.Owner == thread)
+            {
+                pIdle = &slot;
+                break;
+            }
+            if (!pIdle)
+                pIdle = &slot;
+        }
+
+        if ((pIdle == nullptr) && (m_Slots.size() < m_Limit))
+        {
+            auto pCanvas = new GdiCanvas(m_Width, m_Height);
+            m_Slots.push_back(Slot_t{ pCanvas, thread, pCanvas->GetBytes(), false });
+            pIdle = &m_Slots.back();
+        }
+
+        if (pIdle)
+        {
+            pIdle->Owner  = thread;
+            pIdle->Leased = true;
+            m_Leases++;
+            m_PeakLeases = (m_Leases > m_PeakLeases) ? m_Leases : m_PeakLeases;
+            return pIdle->Canvas;
+        }
+        m_Returned.wait(lock);
+    }
+}
+
+void CanvasPool::Release(GdiCanvas* pCanvas)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (auto& slot : m_Slots)
+        {
+            if (slot.Canvas == pCanvas)
+            {
+                pCanvas->FreeScratch();
+                slot.Bytes  = pCanvas->GetBytes();
+                slot.Leased = false;
+                break;
+            }
+        }
+        m_Leases--;
+
+        // The limit may have been lowered while this was out..
+        if (m_Slots.size() > m_Limit)
+            FreeIdle(m_Limit);
+    }
+    m_Returned.notify_one();
+}
+
+void CanvasPool::SetLimit(uint32_t count)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Limit = (count > 0) ? count : 1;
+        FreeIdle(m_Limit);
+    }
+    m_Returned.notify_all();
+}
+
+uint64_t CanvasPool::GetBytes()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    uint64_t bytes = 0;
+    for (auto& slot : m_Slots)
+        bytes += slot.Bytes;
+    return bytes;
+}
+
+void CanvasPool::GetLeaseStats(uint32_t* pCount, uint32_t* pLeases, uint32_t* pPeakLeases)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    *pCount      = (uint32_t)m_Slots.size();
+    *pLeases     = m_Leases;
+    *pPeakLeases = m_PeakLeases;
+}
\ No newline at end of file
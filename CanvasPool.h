@@ -0,0 +1,71 @@
+#ifndef __CanvasPool_H_INCLUDED__
+#define __CanvasPool_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "GdiCanvas.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Process wide set of canvases shared by every manager. A canvas is leased for a single render call and an
+// idle canvas goes back to the thread that used it last when possible. No more than the limit are created,
+// past that a lease waits for one to be returned. Canvases are freed when the last manager detaches, which
+// has to happen before that manager shuts gdiplus down.
+class CanvasPool
+{
+private:
+    struct Slot_t
+    {
+        GdiCanvas* Canvas;
+        std::thread::id Owner; // Thread that leased it last.
+        uint64_t Bytes;        // Measured when returned, scratch is freed by then.
+        bool Leased;
+    };
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Returned;
+    std::vector<Slot_t> m_Slots;
+    int32_t m_Width;
+    int32_t m_Height;
+    uint32_t m_Limit;
+    uint32_t m_Users;
+    uint32_t m_Leases;
+    uint32_t m_PeakLeases;
+
+    CanvasPool(int32_t width, int32_t height);
+    void FreeIdle(size_t keep);
+
+public:
+    static CanvasPool* Get();
+    void Attach();
+    void Detach();
+    GdiCanvas* Acquire();
+    void Release(GdiCanvas* pCanvas);
+    void SetLimit(uint32_t count);
+    int32_t GetWidth() const { return m_Width; }
+    int32_t GetHeight() const { return m_Height; }
+    uint64_t GetBytes();
+    void GetLeaseStats(uint32_t* pCount, uint32_t* pLeases, uint32_t* pPeakLeases);
+};
+
+// Holds a canvas from the pool for the lifetime of the object..
+class CanvasLease
+{
+private:
+    GdiCanvas* m_Canvas;
+
+public:
+    CanvasLease()
+        : m_Canvas(CanvasPool::Get()->Acquire())
+    {}
+    ~CanvasLease() { CanvasPool::Get()->Release(m_Canvas); }
+    CanvasLease(const CanvasLease&) = delete;
+    CanvasLease& operator=(const CanvasLease&) = delete;
+    GdiCanvas* Get() const { return m_Canvas; }
+    GdiCanvas* operator->() const { return m_Canvas; }
+};
+#endif
\ No newline at end of file
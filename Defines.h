@@ -24,6 +24,23 @@ struct GdiFontData_t
     char FontText[4096];
 };
 
+// Compact alternative to GdiFontData_t, text is referenced rather than copied and the family is interned.
+struct GdiFontDesc_t
+{
+    const char* FontText; // UTF-8, does not need to be null terminated.
+    uint32_t FontTextLength;
+    uint32_t FontFamilyId; // Returned by RegisterFontFamily.
+    int32_t BoxHeight;
+    int32_t BoxWidth;
+    float_t FontHeight;
+    float_t OutlineWidth;
+    int32_t FontFlags;
+    uint32_t FontColor;
+    uint32_t OutlineColor;
+    uint32_t GradientStyle;
+    uint32_t GradientColor;
+};
+
 struct GdiRectData_t
 {
     int32_t Width;
@@ -36,6 +53,80 @@ struct GdiRectData_t
     uint32_t GradientColor;
 };
 
+constexpr uint32_t GdiMaxGradientStops = 8;
+constexpr uint32_t GdiMaxFontFallbacks = 4;
+
+struct GdiGradientStop_t
+{
+    float_t Position; // 0 to 1, ascending.
+    uint32_t Color;
+};
+
+// Richer fill than GradientStyle, points are relative to the texture with 0,0 top left and 1,1 bottom right.
+struct GdiGradient_t
+{
+    uint32_t Kind; // 0 linear from start to end, 1 radial around start out to end, 2 angular around start beginning towards end.
+    uint32_t StopCount;
+    GdiGradientStop_t Stops[GdiMaxGradientStops];
+    float_t StartX;
+    float_t StartY;
+    float_t EndX;
+    float_t EndY;
+};
+
+// Shadow or glow drawn beneath the text from its own coverage, a glow is a shadow without an offset.
+struct GdiTextEffect_t
+{
+    int32_t OffsetX;
+    int32_t OffsetY;
+    float_t Radius; // Blur radius in pixels, the gaussian sigma is half of it. Zero leaves a hard edge.
+    float_t Spread; // Pixels the text grows by before it is blurred.
+    uint32_t Color; // The effect is skipped when alpha is zero.
+};
+
+// Text with an optional fill gradient and effects, everything is drawn into a single texture that grows to fit the effects.
+struct GdiTextDesc_t
+{
+    GdiFontDesc_t Font;
+    const GdiGradient_t* Gradient; // May be null.
+    GdiTextEffect_t Shadow;
+    GdiTextEffect_t Glow; // Drawn over the shadow.
+};
+
+// One line of a text block. Top is measured from the oldest line the block still holds and Advance is the space
+// the line takes up, which is a whole number of the font's lines.
+struct GdiTextLine_t
+{
+    IDirect3DTexture8* Texture; // Borrowed from the block, null when the line drew nothing.
+    D3DFORMAT Format;
+    int32_t Width;
+    int32_t Height;
+    int32_t Top;
+    int32_t Advance;
+};
+
+// Widths of the fixed border of a nine-slice texture, the rest stretches. All zero when the texture is not sliced.
+struct GdiNineSlice_t
+{
+    int32_t Left;
+    int32_t Top;
+    int32_t Right;
+    int32_t Bottom;
+};
+
+// Styles installed for a font family, gdiplus can still synthesize the missing ones.
+constexpr uint32_t GdiFontStyleRegular    = 1;
+constexpr uint32_t GdiFontStyleBold       = 2;
+constexpr uint32_t GdiFontStyleItalic     = 4;
+constexpr uint32_t GdiFontStyleBoldItalic = 8;
+
+struct GdiFontInfo_t
+{
+    char Name[LF_FACESIZE * 3]; // UTF-8.
+    uint32_t Styles;
+};
+
+// Returned by value from CreateTexture and CreateRectTexture, the layout existing callers were built against.
 struct GdiFontReturn_t
 {
     int32_t Width;
@@ -49,4 +140,42 @@ struct GdiFontReturn_t
     {}
 };
 
+// Returned by every other texture export, the original fields followed by the texture's actual format and its restore handle.
+struct GdiFontReturnEx_t
+{
+    int32_t Width;
+    int32_t Height;
+    IDirect3DTexture8* Texture;
+    D3DFORMAT Format;
+    uint32_t Handle; // Passed to GetRestoredTexture after a device reset, zero for textures that survive one.
+
+    GdiFontReturnEx_t()
+        : Width(0)
+        , Height(0)
+        , Texture(nullptr)
+        , Format(D3DFMT_UNKNOWN)
+        , Handle(0)
+    {}
+};
+
+// Memory held on behalf of the caller, in bytes. Peaks are high-water marks since the manager was created.
+struct GdiMemoryStats_t
+{
+    uint64_t TextureBytes; // Video memory of textures still referenced by the caller.
+    uint64_t ShadowBytes;  // System memory copies kept by D3DPOOL_MANAGED.
+    uint64_t CanvasBytes; // Shared by every manager in the process.
+    uint64_t CacheBytes; // Rendered bitmaps kept in memory, shared by every manager in the process.
+    uint64_t TotalBytes;
+    uint64_t PeakTextureBytes;
+    uint64_t PeakTotalBytes;
+    uint64_t Budget; // Zero when unlimited.
+    uint32_t TextureCount;
+    uint32_t PeakTextureCount;
+    uint32_t FallbackCount; // Textures created in a smaller format because of the budget.
+    uint64_t StagingBytes;  // System memory textures used to upload into D3DPOOL_DEFAULT, shared by every manager on the device.
+    uint32_t CanvasCount;   // Canvases in the process wide pool.
+    uint32_t CanvasLeases;  // Canvases currently in use by a render call.
+    uint32_t PeakCanvasLeases;
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,270 @@
+#include "DxtEncoder.h"
+#include <string.h>
+#include <thread>
+#include <vector>
+
+static inline uint32_t Div255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+static inline uint16_t To565(uint32_t r, uint32_t g, uint32_t b)
+{
+    return (uint16_t)((Div255(r * 31) << 11) | (Div255(g * 63) << 5) | Div255(b * 31));
+}
+
+static inline void From565(uint16_t c, int32_t* rgb)
+{
+    auto r = (c >> 11) & 31;
+    auto g = (c >> 5) & 63;
+    auto b = c & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Loads a 4x4 block as (r, g, b, a) bytes, zero filling anything past the edges..
+static void FetchBlock(uint8_t* block, const uint8_t* source, int32_t sourcePitch, int32_t x, int32_t y, int32_t width, int32_t height, bool premultiply)
+{
+    memset(block, 0, 64);
+    for (auto by = 0; by < 4 && (y + by) < height; by++)
+    {
+        auto row = (const uint32_t*)(source + ((y + by) * sourcePitch)) + x;
+        for (auto bx = 0; bx < 4 && (x + bx) < width; bx++)
+        {
+            auto px  = row[bx];
+            auto out = block + ((by * 4 + bx) * 4);
+            auto a   = px >> 24;
+            out[0]   = (uint8_t)((px >> 16) & 0xFF);
+            out[1]   = (uint8_t)((px >> 8) & 0xFF);
+            out[2]   = (uint8_t)(px & 0xFF);
+            out[3]   = (uint8_t)a;
+            if (premultiply)
+            {
+                out[0] = (uint8_t)Div255(out[0] * a);
+                out[1] = (uint8_t)Div255(out[1] * a);
+                out[2] = (uint8_t)Div255(out[2] * a);
+            }
+        }
+    }
+}
+
+// Four color block using the bounding box of the visible pixels, inset slightly to reduce error..
+static void EncodeColor(uint8_t* dest, const uint8_t* block)
+{
+    int32_t minC[3] = {255, 255, 255};
+    int32_t maxC[3] = {0, 0, 0};
+    auto visible    = 0;
+    for (auto i = 0; i < 16; i++)
+    {
+        auto px = block + (i * 4);
+        if (px[3] == 0)
+            continue;
+        visible++;
+        for (auto c = 0; c < 3; c++)
+        {
+            if (px[c] < minC[c])
+                minC[c] = px[c];
+            if (px[c] > maxC[c])
+                maxC[c] = px[c];
+        }
+    }
+
+    // Fully transparent block, color is irrelevant..
+    if (visible == 0)
+    {
+        memset(dest, 0, 8);
+        return;
+    }
+
+    for (auto c = 0; c < 3; c++)
+    {
+        auto inset = (maxC[c] - minC[c]) >> 4;
+        minC[c] += inset;
+        maxC[c] -= inset;
+    }
+
+    auto c0 = To565(maxC[0], maxC[1], maxC[2]);
+    auto c1 = To565(minC[0], minC[1], minC[2]);
+    if (c0 < c1)
+    {
+        auto swap = c0;
+        c0        = c1;
+        c1        = swap;
+    }
+
+    uint32_t indices = 0;
+    if (c0 != c1)
+    {
+        // Project each pixel onto the endpoint axis, palette order is c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1..
+        int32_t e0[3], e1[3], axis[3];
+        From565(c0, e0);
+        From565(c1, e1);
+        for (auto c = 0; c < 3; c++)
+            axis[c] = e1[c] - e0[c];
+        auto length = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+        static const uint32_t remap[4] = {0, 2, 3, 1};
+        for (auto i = 0; i < 16; i++)
+        {
+            auto px  = block + (i * 4);
+            auto dot = (px[0] - e0[0]) * axis[0] + (px[1] - e0[1]) * axis[1] + (px[2] - e0[2]) * axis[2];
+            auto t   = (dot <= 0) ? 0 : (dot >= length) ? 3 : (dot * 3 + (length >> 1)) / length;
+            indices |= remap[t] << (i * 2);
+        }
+    }
+
+    dest[0] = (uint8_t)(c0 & 0xFF);
+    dest[1] = (uint8_t)(c0 >> 8);
+    dest[2] = (uint8_t)(c1 & 0xFF);
+    dest[3] = (uint8_t)(c1 >> 8);
+    memcpy(dest + 4, &indices, 4);
+}
+
+static void EncodeAlphaDxt3(uint8_t* dest, const uint8_t* block)
+{
+    for (auto i = 0; i < 8; i++)
+    {
+        auto lo = Div255(block[(i * 2) * 4 + 3] * 15);
+        auto hi = Div255(block[(i * 2 + 1) * 4 + 3] * 15);
+        dest[i] = (uint8_t)(lo | (hi << 4));
+    }
+}
+
+// Builds the DXT5 palette for the given endpoints and returns the squared error of the best indices..
+static uint32_t FitAlphaDxt5(const uint8_t* block, uint8_t a0, uint8_t a1, uint8_t* indices)
+{
+    int32_t palette[8];
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1)
+    {
+        for (auto i = 1; i < 7; i++)
+            palette[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+    }
+    else
+    {
+        for (auto i = 1; i < 5; i++)
+            palette[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint32_t error = 0;
+    for (auto i = 0; i < 16; i++)
+    {
+        auto a         = (int32_t)block[i * 4 + 3];
+        auto best      = 0;
+        auto bestError = 0x7FFFFFFF;
+        for (auto p = 0; p < 8; p++)
+        {
+            auto d = (a - palette[p]) * (a - palette[p]);
+            if (d < bestError)
+            {
+                bestError = d;
+                best      = p;
+            }
+        }
+        indices[i] = (uint8_t)best;
+        error += bestError;
+    }
+    return error;
+}
+
+// Text blocks are mostly 0 and 255 with an anti-aliased ramp between, so try both the eight step mode over the full
+// range and the six step mode (which has exact 0 and 255) over the partial values, and keep whichever fits better..
+static void EncodeAlphaDxt5(uint8_t* dest, const uint8_t* block)
+{
+    uint8_t minA = 255, maxA = 0;
+    uint8_t minInner = 255, maxInner = 0;
+    for (auto i = 0; i < 16; i++)
+    {
+        auto a = block[i * 4 + 3];
+        if (a < minA)
+            minA = a;
+        if (a > maxA)
+            maxA = a;
+        if ((a != 0) && (a != 255))
+        {
+            if (a < minInner)
+                minInner = a;
+            if (a > maxInner)
+                maxInner = a;
+        }
+    }
+
+    uint8_t indices[16];
+    uint8_t a0 = maxA, a1 = minA;
+    if (minA == maxA)
+    {
+        memset(indices, 0, sizeof(indices));
+    }
+    else
+    {
+        auto error = FitAlphaDxt5(block, maxA, minA, indices);
+        if (minInner <= maxInner)
+        {
+            uint8_t inner[16];
+            auto innerError = FitAlphaDxt5(block, minInner, maxInner, inner);
+            if (innerError < error)
+            {
+                a0 = minInner;
+                a1 = maxInner;
+                memcpy(indices, inner, sizeof(indices));
+            }
+        }
+    }
+
+    dest[0]      = a0;
+    dest[1]      = a1;
+    uint64_t bits = 0;
+    for (auto i = 0; i < 16; i++)
+        bits |= (uint64_t)indices[i] << (i * 3);
+    for (auto i = 0; i < 6; i++)
+        dest[2 + i] = (uint8_t)(bits >> (i * 8));
+}
+
+static void EncodeRows(uint8_t* dest, int32_t destPitch, const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height, DxtFormat format, bool premultiply, int32_t firstRow, int32_t lastRow)
+{
+    uint8_t block[64];
+    auto blocksWide = (width + 3) / 4;
+    for (auto by = firstRow; by < lastRow; by++)
+    {
+        auto out = dest + (by * destPitch);
+        for (auto bx = 0; bx < blocksWide; bx++)
+        {
+            FetchBlock(block, source, sourcePitch, bx * 4, by * 4, width, height, premultiply);
+            if (format == DxtFormat::DXT3)
+                EncodeAlphaDxt3(out, block);
+            else
+                EncodeAlphaDxt5(out, block);
+            EncodeColor(out + 8, block);
+            out += 16;
+        }
+    }
+}
+
+void EncodeDxt(uint8_t* dest, int32_t destPitch, const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height, DxtFormat format, bool premultiply, uint32_t maxThreads)
+{
+    // Give each thread at least a few rows of blocks so spawning stays worthwhile..
+    auto blocksHigh = (height + 3) / 4;
+    auto threads    = (uint32_t)(blocksHigh / 16);
+    if (threads > maxThreads)
+        threads = maxThreads;
+    if (threads <= 1)
+    {
+        EncodeRows(dest, destPitch, source, sourcePitch, width, height, format, premultiply, 0, blocksHigh);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    auto rowsPerThread = (int32_t)((blocksHigh + threads - 1) / threads);
+    for (auto first = 0; first < blocksHigh; first += rowsPerThread)
+    {
+        auto last = ((first + rowsPerThread) < blocksHigh) ? (first + rowsPerThread) : blocksHigh;
+        workers.emplace_back(EncodeRows, dest, destPitch, source, sourcePitch, width, height, format, premultiply, first, last);
+    }
+    for (auto& worker : workers)
+        worker.join();
+}
@@ -0,0 +1,20 @@
+#ifndef __DxtEncoder_H_INCLUDED__
+#define __DxtEncoder_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include <stdint.h>
+
+enum class DxtFormat : uint32_t
+{
+    DXT3, // Explicit 4 bit alpha, keeps hard edges sharp.
+    DXT5, // Interpolated alpha, smoother anti-aliased edges.
+};
+
+// Encodes a width x height block of A8R8G8B8 pixels into 16 byte DXT blocks.
+// destPitch is the size of one row of blocks. Pixels past the edges are treated as transparent.
+// The block rows are split across up to maxThreads threads.
+void EncodeDxt(uint8_t* dest, int32_t destPitch, const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height, DxtFormat format, bool premultiply, uint32_t maxThreads);
+#endif
@@ -1,9 +1,16 @@
 #include "GdiFontManager.h"
+#include "FontIndex.h"
+#include "TextBlock.h"
+#include "TextPanel.h"
 
-int CALLBACK EnumFontFamExProc(const LOGFONT* lpelfe, const TEXTMETRIC* lpntme, DWORD FontType, LPARAM lParam)
+// The original exports keep their original return layout..
+static GdiFontReturn_t ToFontReturn(const GdiFontReturnEx_t& ret)
 {
-    *((LPARAM*)lParam) = 1;
-    return 1;
+    GdiFontReturn_t result;
+    result.Width   = ret.Width;
+    result.Height  = ret.Height;
+    result.Texture = ret.Texture;
+    return result;
 }
 
 extern "C"
@@ -18,20 +25,103 @@ extern "C"
     }
     extern __declspec(dllexport) GdiFontReturn_t CreateTexture(GdiFontManager* pFontManager, GdiFontData_t* data)
     {
-        return pFontManager->CreateFontTexture(*data);
+        return ToFontReturn(pFontManager->CreateFontTexture(*data));
+    }
+    extern __declspec(dllexport) uint32_t RegisterFontFamily(GdiFontManager* pFontManager, const char* family)
+    {
+        return pFontManager->RegisterFontFamily(family);
+    }
+    extern __declspec(dllexport) bool SetFontFallbacks(GdiFontManager* pFontManager, uint32_t familyId, const uint32_t* fallbackIds, uint32_t count)
+    {
+        return pFontManager->SetFontFallbacks(familyId, fallbackIds, count);
+    }
+    extern __declspec(dllexport) GdiFontReturnEx_t CreateTextureEx(GdiFontManager* pFontManager, const GdiFontDesc_t* data)
+    {
+        return pFontManager->CreateFontTexture(*data, nullptr);
+    }
+    extern __declspec(dllexport) GdiFontReturnEx_t CreateGradientTexture(GdiFontManager* pFontManager, const GdiFontDesc_t* data, const GdiGradient_t* gradient)
+    {
+        return pFontManager->CreateFontTexture(*data, gradient);
+    }
+    extern __declspec(dllexport) GdiFontReturnEx_t CreateTextTexture(GdiFontManager* pFontManager, const GdiTextDesc_t* data)
+    {
+        return pFontManager->CreateTextTexture(*data);
+    }
+    extern __declspec(dllexport) GdiFontReturnEx_t CreateMarkupTexture(GdiFontManager* pFontManager, const GdiTextDesc_t* data)
+    {
+        return pFontManager->CreateMarkupTexture(*data);
+    }
+    extern __declspec(dllexport) TextBlock* CreateTextBlock(GdiFontManager* pFontManager, const GdiTextDesc_t* style, uint32_t capacity, bool markup)
+    {
+        return pFontManager->CreateTextBlock(*style, capacity, markup);
+    }
+    extern __declspec(dllexport) void DestroyTextBlock(GdiFontManager* pFontManager, TextBlock* pBlock)
+    {
+        pFontManager->DestroyTextBlock(pBlock);
+    }
+    extern __declspec(dllexport) bool AppendTextBlockLine(TextBlock* pBlock, const char* text, uint32_t length)
+    {
+        return pBlock->Append(text, length);
+    }
+    extern __declspec(dllexport) void ClearTextBlock(TextBlock* pBlock)
+    {
+        pBlock->Clear();
+    }
+    extern __declspec(dllexport) void SetTextBlockCapacity(TextBlock* pBlock, uint32_t capacity)
+    {
+        pBlock->SetCapacity(capacity);
+    }
+    extern __declspec(dllexport) uint32_t GetTextBlockLines(TextBlock* pBlock, uint32_t first, GdiTextLine_t* pLines, uint32_t count)
+    {
+        return pBlock->GetLines(first, pLines, count);
+    }
+    extern __declspec(dllexport) uint32_t GetTextBlockLineCount(TextBlock* pBlock)
+    {
+        return pBlock->GetCount();
+    }
+    extern __declspec(dllexport) int32_t GetTextBlockHeight(TextBlock* pBlock)
+    {
+        return pBlock->GetHeight();
+    }
+    extern __declspec(dllexport) TextPanel* CreateTextPanel(GdiFontManager* pFontManager, const GdiFontDesc_t* style, uint32_t lineCount)
+    {
+        return pFontManager->CreateTextPanel(*style, lineCount);
+    }
+    extern __declspec(dllexport) void DestroyTextPanel(GdiFontManager* pFontManager, TextPanel* pPanel)
+    {
+        pFontManager->DestroyTextPanel(pPanel);
+    }
+    extern __declspec(dllexport) GdiFontReturnEx_t UpdateTextPanel(TextPanel* pPanel, const char* text, uint32_t length, uint32_t* pRedrawn)
+    {
+        return pPanel->Update(text, length, pRedrawn);
     }
     extern __declspec(dllexport) GdiFontReturn_t CreateRectTexture(GdiFontManager* pFontManager, GdiRectData_t* data)
     {
-        return pFontManager->CreateRectTexture(*data);
+        return ToFontReturn(pFontManager->CreateRectTexture(*data, nullptr));
+    }
+    extern __declspec(dllexport) GdiFontReturnEx_t CreateGradientRectTexture(GdiFontManager* pFontManager, GdiRectData_t* data, const GdiGradient_t* gradient)
+    {
+        return pFontManager->CreateRectTexture(*data, gradient);
+    }
+    extern __declspec(dllexport) GdiFontReturnEx_t CreateNineSliceRectTexture(GdiFontManager* pFontManager, GdiRectData_t* data, GdiNineSlice_t* pSlice)
+    {
+        return pFontManager->CreateNineSliceRectTexture(*data, pSlice);
     }
     extern __declspec(dllexport) bool GetFontAvailable(const char* font)
     {
-        LOGFONT lf = {0};
-        lf.lfCharSet = DEFAULT_CHARSET;
-        swprintf_s(lf.lfFaceName, 32, L"%S", font);
-        LPARAM lParam = 0;
-        ::EnumFontFamiliesEx(GetDC(nullptr), &lf, EnumFontFamExProc, (LPARAM)&lParam, 0);
-        return lParam ? true : false;
+        return FontIndex::Get()->GetStyles(font) != 0;
+    }
+    extern __declspec(dllexport) uint32_t GetFontStyles(const char* font)
+    {
+        return FontIndex::Get()->GetStyles(font);
+    }
+    extern __declspec(dllexport) uint32_t GetFontList(GdiFontInfo_t* pList, uint32_t capacity)
+    {
+        return FontIndex::Get()->GetList(pList, capacity);
+    }
+    extern __declspec(dllexport) void RefreshFontIndex()
+    {
+        FontIndex::Get()->Refresh();
     }
     extern __declspec(dllexport) void EnableTextureDump(GdiFontManager* pFontManager, const char* folder)
     {
@@ -41,4 +131,88 @@ extern "C"
     {
         pFontManager->DisableTextureDump();
     }
+    extern __declspec(dllexport) void EnablePremultipliedAlpha(GdiFontManager* pFontManager)
+    {
+        pFontManager->EnablePremultipliedAlpha();
+    }
+    extern __declspec(dllexport) void DisablePremultipliedAlpha(GdiFontManager* pFontManager)
+    {
+        pFontManager->DisablePremultipliedAlpha();
+    }
+    extern __declspec(dllexport) bool SetTextureFormat(GdiFontManager* pFontManager, D3DFORMAT format, bool dither)
+    {
+        return pFontManager->SetTextureFormat(format, dither);
+    }
+    extern __declspec(dllexport) bool SetTextureCompression(GdiFontManager* pFontManager, D3DFORMAT format, uint32_t minimumPixels)
+    {
+        return pFontManager->SetTextureCompression(format, minimumPixels);
+    }
+    extern __declspec(dllexport) void EnableMipmaps(GdiFontManager* pFontManager)
+    {
+        pFontManager->EnableMipmaps();
+    }
+    extern __declspec(dllexport) void DisableMipmaps(GdiFontManager* pFontManager)
+    {
+        pFontManager->DisableMipmaps();
+    }
+    extern __declspec(dllexport) void EnableDilatedOutline(GdiFontManager* pFontManager)
+    {
+        pFontManager->EnableDilatedOutline();
+    }
+    extern __declspec(dllexport) void DisableDilatedOutline(GdiFontManager* pFontManager)
+    {
+        pFontManager->DisableDilatedOutline();
+    }
+    extern __declspec(dllexport) bool EnableDiskCache(GdiFontManager* pFontManager, const char* path, uint32_t maxMegabytes)
+    {
+        return pFontManager->EnableDiskCache(path, maxMegabytes);
+    }
+    extern __declspec(dllexport) void DisableDiskCache(GdiFontManager* pFontManager)
+    {
+        pFontManager->DisableDiskCache();
+    }
+    extern __declspec(dllexport) bool PrewarmFromManifest(GdiFontManager* pFontManager, const char* path)
+    {
+        return pFontManager->PrewarmFromManifest(path);
+    }
+    extern __declspec(dllexport) bool GetPrewarmProgress(GdiFontManager* pFontManager, uint32_t* pCompleted, uint32_t* pTotal)
+    {
+        return pFontManager->GetPrewarmProgress(pCompleted, pTotal);
+    }
+    extern __declspec(dllexport) void CancelPrewarm(GdiFontManager* pFontManager)
+    {
+        pFontManager->CancelPrewarm();
+    }
+    extern __declspec(dllexport) void SetMemoryBudget(GdiFontManager* pFontManager, uint64_t bytes)
+    {
+        pFontManager->SetMemoryBudget(bytes);
+    }
+    extern __declspec(dllexport) void GetMemoryStats(GdiFontManager* pFontManager, GdiMemoryStats_t* pStats)
+    {
+        pFontManager->GetMemoryStats(pStats);
+    }
+    extern __declspec(dllexport) void SetCanvasPoolLimit(GdiFontManager* pFontManager, uint32_t count)
+    {
+        pFontManager->SetCanvasPoolLimit(count);
+    }
+    extern __declspec(dllexport) void EnableDefaultPool(GdiFontManager* pFontManager)
+    {
+        pFontManager->EnableDefaultPool();
+    }
+    extern __declspec(dllexport) void DisableDefaultPool(GdiFontManager* pFontManager)
+    {
+        pFontManager->DisableDefaultPool();
+    }
+    extern __declspec(dllexport) void OnDeviceLost(GdiFontManager* pFontManager)
+    {
+        pFontManager->OnDeviceLost();
+    }
+    extern __declspec(dllexport) void OnDeviceReset(GdiFontManager* pFontManager)
+    {
+        pFontManager->OnDeviceReset();
+    }
+    extern __declspec(dllexport) IDirect3DTexture8* GetRestoredTexture(GdiFontManager* pFontManager, uint32_t handle)
+    {
+        return pFontManager->GetRestoredTexture(handle);
+    }
 }
\ No newline at end of file
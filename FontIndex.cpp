@@ -0,0 +1,181 @@
+#include "FontIndex.h"
+#include <algorithm>
+
+static bool LessThanIgnoreCase(const std::wstring& lhs, const std::wstring& rhs)
+{
+    return _wcsicmp(lhs.c_str(), rhs.c_str()) < 0;
+}
+
+int CALLBACK EnumFamilyProc(const LOGFONTW* pLogFont, const TEXTMETRICW* pMetric, DWORD fontType, LPARAM lParam)
+{
+    // Vertical variants share the family with an @ in front..
+    if (pLogFont->lfFaceName[0] != L'@')
+        ((std::vector<std::wstring>*)lParam)->push_back(pLogFont->lfFaceName);
+    return 1;
+}
+
+int CALLBACK EnumStyleProc(const LOGFONTW* pLogFont, const TEXTMETRICW* pMetric, DWORD fontType, LPARAM lParam)
+{
+    auto bold   = pLogFont->lfWeight >= FW_BOLD;
+    auto italic = pLogFont->lfItalic != 0;
+    *((uint32_t*)lParam) |= bold ? (italic ? GdiFontStyleBoldItalic : GdiFontStyleBold) : (italic ? GdiFontStyleItalic : GdiFontStyleRegular);
+    return 1;
+}
+
+FontIndex::FontIndex()
+    : m_Stale(true)
+{}
+
+FontIndex* FontIndex::Get()
+{
+    static FontIndex index;
+    return &index;
+}
+
+void FontIndex::Refresh()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stale = true;
+}
+
+uint32_t FontIndex::EnumerateStyles(HDC hdc, const wchar_t* name)
+{
+    LOGFONTW lf  = { 0 };
+    lf.lfCharSet = DEFAULT_CHARSET;
+    wcsncpy_s(lf.lfFaceName, name, _TRUNCATE);
+    uint32_t styles = 0;
+    ::EnumFontFamiliesExW(hdc, &lf, EnumStyleProc, (LPARAM)&styles, 0);
+    return styles;
+}
+
+// Enumerates every family once, then the styles of each, caller holds the lock..
+void FontIndex::Build()
+{
+    m_Entries.clear();
+    m_Aliases.clear();
+    m_Coverage.clear();
+    m_Stale  = false;
+    auto hdc = ::GetDC(nullptr);
+
+    // An empty face name gives one font per family and character set..
+    std::vector<std::wstring> names;
+    LOGFONTW lf  = { 0 };
+    lf.lfCharSet = DEFAULT_CHARSET;
+    ::EnumFontFamiliesExW(hdc, &lf, EnumFamilyProc, (LPARAM)&names, 0);
+    std::sort(names.begin(), names.end(), LessThanIgnoreCase);
+    names.erase(std::unique(names.begin(), names.end(), [](const std::wstring& lhs, const std::wstring& rhs) { return _wcsicmp(lhs.c_str(), rhs.c_str()) == 0; }), names.end());
+
+    m_Entries.reserve(names.size());
+    for (auto& name : names)
+    {
+        char buffer[LF_FACESIZE * 3];
+        if (::WideCharToMultiByte(CP_UTF8, 0, name.c_str(), -1, buffer, sizeof(buffer), nullptr, nullptr) == 0)
+            continue;
+
+        Entry_t entry;
+        entry.Name     = name;
+        entry.Utf8Name = buffer;
+        entry.Styles   = EnumerateStyles(hdc, name.c_str());
+        m_Entries.push_back(std::move(entry));
+    }
+    ::ReleaseDC(nullptr, hdc);
+}
+
+// Binary search by name, caller holds the lock. Names that are not valid UTF-8 are read in the ANSI code page..
+const FontIndex::Entry_t* FontIndex::Find(const char* family)
+{
+    if (m_Stale)
+        Build();
+
+    wchar_t wBuffer[LF_FACESIZE];
+    if ((::MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, family, -1, wBuffer, LF_FACESIZE) == 0) && (::MultiByteToWideChar(CP_ACP, 0, family, -1, wBuffer, LF_FACESIZE) == 0))
+        return nullptr;
+
+    auto compare = [](const Entry_t& entry, const wchar_t* name) { return _wcsicmp(entry.Name.c_str(), name) < 0; };
+    auto iter    = std::lower_bound(m_Entries.begin(), m_Entries.end(), wBuffer, compare);
+    if ((iter != m_Entries.end()) && (_wcsicmp(iter->Name.c_str(), wBuffer) == 0))
+        return &(*iter);
+
+    // Ask gdi about names the index does not list, once..
+    iter = std::lower_bound(m_Aliases.begin(), m_Aliases.end(), wBuffer, compare);
+    if ((iter == m_Aliases.end()) || (_wcsicmp(iter->Name.c_str(), wBuffer) != 0))
+    {
+        Entry_t alias;
+        alias.Name   = wBuffer;
+        auto hdc     = ::GetDC(nullptr);
+        alias.Styles = EnumerateStyles(hdc, wBuffer);
+        ::ReleaseDC(nullptr, hdc);
+        iter = m_Aliases.insert(iter, std::move(alias));
+    }
+    return &(*iter);
+}
+
+// Returns the styles installed for a family, zero if it is not installed..
+uint32_t FontIndex::GetStyles(const char* family)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto pEntry = Find(family);
+    return pEntry ? pEntry->Styles : 0;
+}
+
+// Copies up to capacity families in name order and returns how many there are in total..
+uint32_t FontIndex::GetList(GdiFontInfo_t* pList, uint32_t capacity)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Stale)
+        Build();
+
+    for (uint32_t i = 0; (i < capacity) && (i < m_Entries.size()); i++)
+    {
+        strcpy_s(pList[i].Name, m_Entries[i].Utf8Name.c_str());
+        pList[i].Styles = m_Entries[i].Styles;
+    }
+    return (uint32_t)m_Entries.size();
+}
+
+// Returns which code units the family has glyphs for, gdi substitutes another font for a missing family..
+std::shared_ptr<const FontCoverage_t> FontIndex::GetCoverage(const std::wstring& family)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Stale)
+        Build();
+
+    auto key = family;
+    ::CharLowerBuffW(&key[0], (DWORD)key.size());
+    auto iter = m_Coverage.find(key);
+    if (iter != m_Coverage.end())
+        return iter->second;
+
+    auto pCoverage = std::make_shared<FontCoverage_t>(); // Value initialized, so no bits are set.
+    LOGFONTW lf  = { 0 };
+    lf.lfCharSet = DEFAULT_CHARSET;
+    wcsncpy_s(lf.lfFaceName, family.c_str(), _TRUNCATE);
+    auto hdc     = ::CreateCompatibleDC(nullptr);
+    auto hFont   = ::CreateFontIndirectW(&lf);
+    auto hOld    = ::SelectObject(hdc, hFont);
+    auto size    = ::GetFontUnicodeRanges(hdc, nullptr);
+    if (size != 0)
+    {
+        std::vector<uint8_t> buffer(size);
+        auto pGlyphs = (GLYPHSET*)buffer.data();
+        if (::GetFontUnicodeRanges(hdc, pGlyphs) != 0)
+        {
+            for (DWORD i = 0; i < pGlyphs->cRanges; i++)
+            {
+                uint32_t first = pGlyphs->ranges[i].wcLow;
+                uint32_t last  = first + pGlyphs->ranges[i].cGlyphs;
+                for (auto c = first; (c < last) && (c < 0x10000); c++)
+                {
+                    if ((c < 0xD800) || (c > 0xDFFF))
+                        pCoverage->Bits[c >> 6] |= 1ull << (c & 63);
+                }
+            }
+        }
+    }
+    ::SelectObject(hdc, hOld);
+    ::DeleteObject(hFont);
+    ::DeleteDC(hdc);
+
+    m_Coverage[key] = pCoverage;
+    return pCoverage;
+}
\ No newline at end of file
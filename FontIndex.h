@@ -0,0 +1,55 @@
+#ifndef __FontIndex_H_INCLUDED__
+#define __FontIndex_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "Defines.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One bit per UTF-16 code unit a font has a glyph for, surrogates are never set.
+struct FontCoverage_t
+{
+    uint64_t Bits[65536 / 64];
+
+    bool Covers(wchar_t c) const { return ((Bits[c >> 6] >> (c & 63)) & 1) != 0; }
+};
+
+// Installed font families sorted by case-insensitive name, built on first use. Gdi also matches localized
+// family names the enumeration does not list, so misses are looked up once and remembered. Refresh marks the
+// index stale so the next query enumerates again, hosts call it when they see WM_FONTCHANGE. Glyph coverage
+// is read from a font's cmap the first time it is asked for and shared until the index is rebuilt.
+class FontIndex
+{
+private:
+    struct Entry_t
+    {
+        std::wstring Name;
+        std::string Utf8Name;
+        uint32_t Styles;
+    };
+
+    std::mutex m_Mutex;
+    std::vector<Entry_t> m_Entries;
+    std::vector<Entry_t> m_Aliases; // Other names gdi matched, or did not, when asked for them.
+    std::map<std::wstring, std::shared_ptr<const FontCoverage_t>> m_Coverage; // Keyed by lower case name.
+    bool m_Stale;
+
+    FontIndex();
+    void Build();
+    static uint32_t EnumerateStyles(HDC hdc, const wchar_t* name);
+    const Entry_t* Find(const char* family);
+
+public:
+    static FontIndex* Get();
+    void Refresh();
+    uint32_t GetStyles(const char* family);
+    uint32_t GetList(GdiFontInfo_t* pList, uint32_t capacity);
+    std::shared_ptr<const FontCoverage_t> GetCoverage(const std::wstring& family);
+};
+#endif
\ No newline at end of file
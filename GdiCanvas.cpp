@@ -0,0 +1,141 @@
+#include "GdiCanvas.h"
+
+GdiCanvas::GdiCanvas(int32_t width, int32_t height)
+    : m_Width(width)
+    , m_Height(height)
+    , m_Stride(width * 4)
+    , m_Masks{}
+    , m_Distances(nullptr)
+{
+    // Create bitmap in memory..
+    auto size  = m_Stride * m_Height;
+    m_RawImage = malloc(size + 108);
+    m_Pixels   = (uint8_t*)m_RawImage + 108;
+    memset(m_RawImage, 0, size + 108);
+    auto p_Header              = (BITMAPV4HEADER*)m_RawImage;
+    p_Header->bV4Size          = sizeof(BITMAPV4HEADER);
+    p_Header->bV4Width         = m_Width;
+    p_Header->bV4Height        = m_Height;
+    p_Header->bV4Planes        = 1;
+    p_Header->bV4BitCount      = 32;
+    p_Header->bV4V4Compression = BI_BITFIELDS;
+    p_Header->bV4RedMask       = 0x00FF0000;
+    p_Header->bV4GreenMask     = 0x0000FF00;
+    p_Header->bV4BlueMask      = 0x000000FF;
+    p_Header->bV4AlphaMask     = 0xFF000000;
+
+    // Create gdiplus objects using bitmap in memory..
+    m_Bitmap   = new Gdiplus::Bitmap(m_Width, m_Height, m_Stride, PixelFormat32bppARGB, (BYTE*)m_Pixels);
+    m_Graphics = new Gdiplus::Graphics(m_Bitmap);
+    m_Graphics->SetPixelOffsetMode(Gdiplus::PixelOffsetModeHighQuality);
+    m_Graphics->SetCompositingMode(Gdiplus::CompositingModeSourceOver);
+    m_Graphics->SetCompositingQuality(Gdiplus::CompositingQualityHighQuality);
+    m_Graphics->SetSmoothingMode(Gdiplus::SmoothingModeAntiAlias);
+    m_Graphics->SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
+    m_Graphics->SetTextRenderingHint(Gdiplus::TextRenderingHintClearTypeGridFit);
+}
+
+GdiCanvas::~GdiCanvas()
+{
+    delete m_Graphics;
+    delete m_Bitmap;
+    free(m_RawImage);
+    free(m_Masks[0]);
+    free(m_Masks[1]);
+    free(m_Masks[2]);
+    free(m_Distances);
+}
+
+// Eight bit scratch buffers the size of the canvas, each plane is allocated on first use..
+uint8_t* GdiCanvas::GetMask(uint32_t plane)
+{
+    if (!m_Masks[plane])
+        m_Masks[plane] = (uint8_t*)malloc(m_Width * m_Height);
+    return m_Masks[plane];
+}
+
+// Two 16 bit values per canvas pixel for DilateMask, allocated on first use like the mask planes..
+int16_t* GdiCanvas::GetDistances()
+{
+    if (!m_Distances)
+        m_Distances = (int16_t*)malloc((size_t)m_Width * m_Height * 2 * sizeof(int16_t));
+    return m_Distances;
+}
+
+// Scratch only lives as long as a lease, an idle canvas in the pool keeps just its pixels..
+void GdiCanvas::FreeScratch()
+{
+    for (auto& pMask : m_Masks)
+    {
+        free(pMask);
+        pMask = nullptr;
+    }
+    free(m_Distances);
+    m_Distances = nullptr;
+}
+
+// Pixels plus whichever mask planes and distance buffers have been allocated..
+uint64_t GdiCanvas::GetBytes() const
+{
+    uint64_t bytes = (uint64_t)m_Stride * m_Height;
+    for (auto pMask : m_Masks)
+        bytes += pMask ? ((uint64_t)m_Width * m_Height) : 0;
+    bytes += m_Distances ? ((uint64_t)m_Width * m_Height * 2 * sizeof(int16_t)) : 0;
+    return bytes;
+}
+
+void GdiCanvas::Clear(int32_t width, int32_t height)
+{
+    auto clearStride = width * 4;
+    auto pixels      = m_Pixels;
+    for (int x = 0; x < height; x++)
+    {
+        memset(pixels, 0, clearStride);
+        pixels += m_Stride;
+    }
+}
+
+bool GdiCanvas::Trim(int32_t width, int32_t height, CanvasRegion_t* pRegion) const
+{
+    // Examine raw pixels to get exact texture size(gdiplus does not calculate pixel perfect size)..
+    int32_t firstPx = width - 1;
+    int32_t lastPx  = 0;
+    int32_t lastRow = -1;
+    uint32_t* px    = (uint32_t*)m_Pixels;
+    for (auto y = 0; y < height; y++)
+    {
+        for (auto x = (width - 1); x >= lastPx; x--)
+        {
+            if (px[x])
+            {
+                lastRow = y;
+                lastPx  = x;
+            }
+        }
+
+        for (auto x = 0; x < width; x++)
+        {
+            if (px[x])
+            {
+                lastRow = y;
+                if (x < firstPx)
+                {
+                    firstPx = x;
+                }
+                break;
+            }
+        }
+
+        px += m_Width;
+    }
+
+    // Nothing was drawn..
+    if ((lastRow < 0) || (lastPx < firstPx))
+        return false;
+
+    pRegion->Pixels = m_Pixels + (firstPx * 4);
+    pRegion->Pitch  = m_Stride;
+    pRegion->Width  = (lastPx - firstPx) + 1;
+    pRegion->Height = lastRow + 1;
+    return true;
+}
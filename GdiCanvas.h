@@ -0,0 +1,49 @@
+#ifndef __GdiCanvas_H_INCLUDED__
+#define __GdiCanvas_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "Defines.h"
+
+// Region of a canvas (or any A8R8G8B8 buffer) holding a rendered result.
+struct CanvasRegion_t
+{
+    const uint8_t* Pixels;
+    int32_t Pitch;
+    int32_t Width;
+    int32_t Height;
+};
+
+// In-memory A8R8G8B8 bitmap with a gdiplus graphics context drawing into it.
+// A canvas is only ever used by one thread at a time.
+class GdiCanvas
+{
+private:
+    int32_t m_Width;
+    int32_t m_Height;
+    int32_t m_Stride;
+    void* m_RawImage;
+    uint8_t* m_Pixels;
+    uint8_t* m_Masks[3];
+    int16_t* m_Distances;
+    Gdiplus::Bitmap* m_Bitmap;
+    Gdiplus::Graphics* m_Graphics;
+
+public:
+    GdiCanvas(int32_t width, int32_t height);
+    ~GdiCanvas();
+    int32_t GetWidth() const { return m_Width; }
+    int32_t GetHeight() const { return m_Height; }
+    int32_t GetStride() const { return m_Stride; }
+    uint8_t* GetPixels() const { return m_Pixels; }
+    Gdiplus::Graphics* GetGraphics() const { return m_Graphics; }
+    uint8_t* GetMask(uint32_t plane);
+    int16_t* GetDistances();
+    void FreeScratch();
+    uint64_t GetBytes() const;
+    void Clear(int32_t width, int32_t height);
+    bool Trim(int32_t width, int32_t height, CanvasRegion_t* pRegion) const;
+};
+#endif
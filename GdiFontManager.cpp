@@ -1,6 +1,26 @@
 #include "GdiFontManager.h"
+#include "CanvasPool.h"
+#include "DxtEncoder.h"
+#include "GdiCanvas.h"
+#include "GdiRuntime.h"
+#include "Gradient.h"
+#include "Hash.h"
+#include "MarkupParser.h"
+#include "MaskBlur.h"
+#include "MaskDilation.h"
+#include "PackFile.h"
+#include "PixelKernels.h"
+#include "RasterCache.h"
+#include "RectRasterizer.h"
+#include "StagingRing.h"
+#include "TextBlock.h"
+#include "TextPanel.h"
+#include "TextureTracker.h"
+#include "Utf8.h"
 #include <filesystem>
+#include <fstream>
 #include <locale>
+#include <thread>
 
 int GetEncoderClsid(const WCHAR* format, CLSID* pClsid)
 {
@@ -33,89 +53,762 @@ int GetEncoderClsid(const WCHAR* format, CLSID* pClsid)
     return -1; // Failure
 }
 
+bool GetBlitFormat(D3DFORMAT format, BlitFormat* pFormat)
+{
+    switch (format)
+    {
+        case D3DFMT_A8R8G8B8:
+        case D3DFMT_X8R8G8B8:
+            *pFormat = BlitFormat::A8R8G8B8;
+            return true;
+        case D3DFMT_A4R4G4B4:
+            *pFormat = BlitFormat::A4R4G4B4;
+            return true;
+        case D3DFMT_A1R5G5B5:
+            *pFormat = BlitFormat::A1R5G5B5;
+            return true;
+        case D3DFMT_A8:
+            *pFormat = BlitFormat::A8;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Only the stops in use are part of the hash..
+uint64_t HashGradient(const GdiGradient_t& gradient, uint64_t seed)
+{
+    auto stopCount = (gradient.StopCount < GdiMaxGradientStops) ? gradient.StopCount : GdiMaxGradientStops;
+    auto hash      = HashValue(gradient.Kind, seed);
+    hash           = HashValue(stopCount, hash);
+    hash           = HashBytes(gradient.Stops, stopCount * sizeof(GdiGradientStop_t), hash);
+    hash           = HashValue(gradient.StartX, hash);
+    hash           = HashValue(gradient.StartY, hash);
+    hash           = HashValue(gradient.EndX, hash);
+    return HashValue(gradient.EndY, hash);
+}
+
+// Scales the relative points of a gradient descriptor to a width x height box..
+void GetGradientShape(const GdiGradient_t& gradient, int32_t width, int32_t height, GradientShape_t* pShape)
+{
+    pShape->Kind   = (gradient.Kind == 1) ? GradientKind::Radial : ((gradient.Kind == 2) ? GradientKind::Angular : GradientKind::Linear);
+    pShape->StartX = gradient.StartX * (float)width;
+    pShape->StartY = gradient.StartY * (float)height;
+    pShape->EndX   = gradient.EndX * (float)width;
+    pShape->EndY   = gradient.EndY * (float)height;
+}
+
+// Markup runs sharing a fill color..
+struct MarkupLayer_t
+{
+    Gdiplus::GraphicsPath* Path;
+    uint32_t Color;
+};
+
+// Index in the chain of the first font with a glyph for c. Surrogates stay with the font before them and code
+// units no font covers use the primary..
+uint32_t PickFont(const FontChain_t& chain, wchar_t c, uint32_t previous)
+{
+    if (chain.Count < 2)
+        return 0;
+    if ((c >= 0xD800) && (c <= 0xDFFF))
+        return previous;
+    for (uint32_t i = 0; i < chain.Count; i++)
+    {
+        if (chain.Coverage[i]->Covers(c))
+            return i;
+    }
+    return 0;
+}
+
+// Design metrics scaled to emSize, using the style if the family has it..
+void GetFontMetrics(Gdiplus::FontFamily* pFamily, INT style, float emSize, float* pAscent, float* pLineSpacing)
+{
+    if (!pFamily->IsStyleAvailable(style))
+        style = Gdiplus::FontStyleRegular;
+    auto scale    = emSize / pFamily->GetEmHeight(style);
+    *pAscent      = scale * pFamily->GetCellAscent(style);
+    *pLineSpacing = scale * pFamily->GetLineSpacing(style);
+}
+
+// Adds one line of text in a single style with its baseline at y, split between the chain's fonts where the
+// primary has no glyph. Returns how far it advances..
+float AddTextRun(Gdiplus::GraphicsPath* pPath, Gdiplus::Graphics* pGraphics, const FontChain_t& chain, const wchar_t* text, INT length, INT style, float emSize, float x, float y)
+{
+    auto pFormat = GdiRuntime::Get()->GetRunFormat();
+    auto left    = x;
+    INT start    = 0;
+    auto current = (length > 0) ? PickFont(chain, text[0], 0) : 0;
+    for (INT i = 1; i <= length; i++)
+    {
+        auto next = (i < length) ? PickFont(chain, text[i], current) : current;
+        if ((i < length) && (next == current))
+            continue;
+
+        auto pFamily  = chain.Families[current];
+        auto runStyle = pFamily->IsStyleAvailable(style) ? style : (INT)Gdiplus::FontStyleRegular;
+        float ascent, lineSpacing;
+        GetFontMetrics(pFamily, runStyle, emSize, &ascent, &lineSpacing);
+        pPath->AddString(text + start, i - start, pFamily, runStyle, emSize, Gdiplus::PointF(x, y - ascent), pFormat);
+
+        Gdiplus::Font font(pFamily, emSize, runStyle, Gdiplus::UnitPixel);
+        Gdiplus::RectF bounds;
+        pGraphics->MeasureString(text + start, i - start, &font, Gdiplus::PointF(0.0f, 0.0f), pFormat, &bounds);
+        x      += bounds.Width;
+        start   = i;
+        current = next;
+    }
+    return x - left;
+}
+
+// Adds text line by line through AddTextRun, on the primary font's baseline and line spacing and without
+// wrapping. Returns false without touching the path when the primary font covers everything..
+bool AddFallbackString(Gdiplus::GraphicsPath* pPath, Gdiplus::Graphics* pGraphics, const FontChain_t& chain, const wchar_t* text, INT length, INT style, float emSize, float left, float top)
+{
+    INT first = 0;
+    while ((first < length) && (PickFont(chain, text[first], 0) == 0))
+        first++;
+    if (first == length)
+        return false;
+
+    float baseline, lineSpacing;
+    GetFontMetrics(chain.Families[0], style, emSize, &baseline, &lineSpacing);
+    auto y    = top;
+    INT start = 0;
+    for (INT i = 0; i <= length; i++)
+    {
+        if ((i < length) && (text[i] != L'\n'))
+            continue;
+        AddTextRun(pPath, pGraphics, chain, text + start, i - start, style, emSize, left, y + baseline);
+        y     += lineSpacing;
+        start  = i + 1;
+    }
+    return true;
+}
+
+// Lays out markup line by line. Each line is read twice, once for the tallest ascent and line spacing of its
+// runs so they share a baseline, then again to add them. Runs of one color go in one layer, and every run
+// is also added to the path used for bounds, masks and outlines..
+void AddMarkupString(Gdiplus::GraphicsPath* pPath, std::vector<MarkupLayer_t>* pLayers, Gdiplus::Graphics* pGraphics, const FontChain_t& chain, const wchar_t* text, INT length, const GdiFontDesc_t& data, float left, float top)
+{
+    MarkupStyle_t base{ data.FontColor, data.FontHeight, data.FontFlags };
+    MarkupParser parser((const uint16_t*)text, (uint32_t)length, base);
+    MarkupRun_t run;
+    auto y       = top;
+    auto hasRun  = parser.Next(&run);
+    while (hasRun)
+    {
+        float baseline = 0.0f;
+        float spacing  = 0.0f;
+        auto measure   = parser;
+        auto next      = run;
+        do
+        {
+            float ascent, lineSpacing;
+            GetFontMetrics(chain.Families[0], next.Style.Flags, next.Style.Size, &ascent, &lineSpacing);
+            baseline = (ascent > baseline) ? ascent : baseline;
+            spacing  = (lineSpacing > spacing) ? lineSpacing : spacing;
+        } while (measure.Next(&next) && !next.NewLine);
+
+        auto x = left;
+        do
+        {
+            if (run.Length != 0)
+            {
+                if (pLayers->empty() || (pLayers->back().Color != run.Style.Color))
+                    pLayers->push_back(MarkupLayer_t{ new Gdiplus::GraphicsPath(), run.Style.Color });
+                x += AddTextRun(pLayers->back().Path, pGraphics, chain, (const wchar_t*)run.Text, (INT)run.Length, run.Style.Flags, run.Style.Size, x, y + baseline);
+            }
+            hasRun = parser.Next(&run);
+        } while (hasRun && !run.NewLine);
+        y += spacing;
+    }
+
+    for (auto& layer : *pLayers)
+        pPath->AddPath(layer.Path, FALSE);
+}
+
+// Effects with no alpha hash the same whatever their other fields are..
+uint64_t HashTextEffect(const GdiTextEffect_t& effect, uint64_t seed)
+{
+    if ((effect.Color & 0xFF000000) == 0)
+        return HashValue(0u, seed);
+    auto hash = HashValue(effect.OffsetX, seed);
+    hash      = HashValue(effect.OffsetY, hash);
+    hash      = HashValue(effect.Radius, hash);
+    hash      = HashValue(effect.Spread, hash);
+    return HashValue(effect.Color, hash);
+}
+
+// Pixels an effect can reach past the text before its offset, grow is how far the text already extends past its fill..
+int32_t GetTextEffectReach(const GdiTextEffect_t& effect, float grow)
+{
+    auto spread = (effect.Spread > 0.0f) ? effect.Spread : 0.0f;
+    return (int32_t)ceil(spread + grow) + GetBlurExtent(effect.Radius) + 1;
+}
+
+// Grows and blurs the fill mask in plane 0 and composites it in the effect color, offset by the effect..
+void DrawTextEffect(GdiCanvas* pCanvas, const GdiTextEffect_t& effect, float grow, int32_t width, int32_t height)
+{
+    auto spread = ((effect.Spread > 0.0f) ? effect.Spread : 0.0f) + grow;
+    auto pMask  = pCanvas->GetMask(1);
+    if (spread > 0.0f)
+        DilateMask(pMask, width, pCanvas->GetMask(0), width, width, height, spread, pCanvas->GetDistances());
+    else
+        memcpy(pMask, pCanvas->GetMask(0), width * height);
+    BlurMask(pMask, pCanvas->GetMask(2), width, height, effect.Radius);
+
+    // Only the part of the shifted mask that lands on the canvas is drawn..
+    auto offsetX = (effect.OffsetX < 0) ? -effect.OffsetX : effect.OffsetX;
+    auto offsetY = (effect.OffsetY < 0) ? -effect.OffsetY : effect.OffsetY;
+    if ((offsetX >= width) || (offsetY >= height))
+        return;
+    auto pDest = pCanvas->GetPixels() + ((effect.OffsetY > 0) ? (effect.OffsetY * pCanvas->GetStride()) : 0) + ((effect.OffsetX > 0) ? (effect.OffsetX * 4) : 0);
+    pMask += ((effect.OffsetY < 0) ? (offsetY * width) : 0) + ((effect.OffsetX < 0) ? offsetX : 0);
+
+    GradientShape_t shape;
+    uint32_t lut[GradientLutSize];
+    BuildGradientLut(effect.Color, effect.Color, lut);
+    GetGradientLine(0, width, height, &shape);
+    CompositeGradient(pDest, pCanvas->GetStride(), pMask, width, width - offsetX, height - offsetY, lut, shape);
+}
+
+// Rough size of a texture before it exists, used to decide whether it fits the memory budget..
+uint64_t EstimateTextureBytes(D3DFORMAT format, int32_t width, int32_t height, bool mipmaps)
+{
+    uint64_t bytes = (uint64_t)width * (uint64_t)height;
+    switch (format)
+    {
+        case D3DFMT_A8R8G8B8:
+        case D3DFMT_X8R8G8B8:
+            bytes *= 4;
+            break;
+        case D3DFMT_A4R4G4B4:
+        case D3DFMT_A1R5G5B5:
+            bytes *= 2;
+            break;
+        default:
+            break;
+    }
+    return mipmaps ? (bytes + bytes / 3) : bytes;
+}
+
+// Identifies the installed font file behind a family by name, file size and the modified stamp in its head table..
+uint64_t GetFontIdentity(const wchar_t* family)
+{
+    auto hash = HashBytes(family, wcslen(family) * sizeof(wchar_t));
+
+    LOGFONTW lf = {0};
+    lf.lfCharSet = DEFAULT_CHARSET;
+    wcsncpy_s(lf.lfFaceName, family, _TRUNCATE);
+    HDC hdc    = ::CreateCompatibleDC(nullptr);
+    HFONT font = ::CreateFontIndirectW(&lf);
+    if (hdc && font)
+    {
+        auto previous  = ::SelectObject(hdc, font);
+        DWORD fileSize = ::GetFontData(hdc, 0, 0, nullptr, 0);
+        uint8_t modified[8]{};
+        ::GetFontData(hdc, 0x64616568 /* 'head' */, 28, modified, sizeof(modified));
+        hash = HashValue(fileSize, hash);
+        hash = HashBytes(modified, sizeof(modified), hash);
+        ::SelectObject(hdc, previous);
+    }
+    if (font)
+        ::DeleteObject(font);
+    if (hdc)
+        ::DeleteDC(hdc);
+    return hash;
+}
+
+// Manifest text escapes newlines, tabs and backslashes..
+std::string UnescapeManifestText(const std::string& text)
+{
+    std::string result;
+    result.reserve(text.size());
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        if ((text[i] == '\\') && ((i + 1) < text.size()))
+        {
+            auto next = text[++i];
+            result += (next == 'n') ? '\n' : (next == 't') ? '\t' : next;
+        }
+        else
+        {
+            result += text[i];
+        }
+    }
+    return result;
+}
+
 GdiFontManager::GdiFontManager(IDirect3DDevice8* pDevice)
     : m_Device(pDevice)
-    , m_CanvasWidth(2048)
-    , m_CanvasHeight(2048)
+    , m_CanvasWidth(CanvasPool::Get()->GetWidth())
+    , m_CanvasHeight(CanvasPool::Get()->GetHeight())
     , m_SaveToHardDrive(false)
+    , m_Premultiply(false)
+    , m_TextureFormat(D3DFMT_A8R8G8B8)
+    , m_Dither(false)
+    , m_CompressionFormat(D3DFMT_UNKNOWN)
+    , m_CompressionThreshold(0)
+    , m_GenerateMipmaps(false)
+    , m_TexturePool(D3DPOOL_MANAGED)
+    , m_DilatedOutline(false)
+    , m_DiskCache(nullptr)
+    , m_MemoryBudget(0)
+    , m_PeakTextureBytes(0)
+    , m_PeakTotalBytes(0)
+    , m_PeakTextureCount(0)
+    , m_FallbackCount(0)
+    , m_PrewarmNext(0)
+    , m_PrewarmCompleted(0)
+    , m_PrewarmCancel(false)
 {
-    Gdiplus::GdiplusStartupInput gdiplusStartupInput;
-    Gdiplus::GdiplusStartup(&m_GDIToken, &gdiplusStartupInput, NULL);
-
-    // Create bitmap in memory..
-    m_Size     = m_CanvasWidth * m_CanvasHeight * 4;
-    m_RawImage = malloc(m_Size + 108);
-    m_Pixels   = (uint8_t*)m_RawImage + 108;
-    memset(m_RawImage, 0, m_Size + 108);
-    auto p_Header              = (BITMAPV4HEADER*)m_RawImage;
-    p_Header->bV4Size          = sizeof(BITMAPV4HEADER);
-    p_Header->bV4Width         = m_CanvasWidth;
-    p_Header->bV4Height        = m_CanvasHeight;
-    p_Header->bV4Planes        = 1;
-    p_Header->bV4BitCount      = 32;
-    p_Header->bV4V4Compression = BI_BITFIELDS;
-    p_Header->bV4RedMask       = 0x00FF0000;
-    p_Header->bV4GreenMask     = 0x0000FF00;
-    p_Header->bV4BlueMask      = 0x000000FF;
-    p_Header->bV4AlphaMask     = 0xFF000000;
-
-    // Create gdiplus objects using bitmap in memory..
-    this->m_CanvasStride = m_CanvasWidth * 4;
-    this->m_Bitmap       = new Gdiplus::Bitmap(m_CanvasWidth, m_CanvasHeight, m_CanvasStride, PixelFormat32bppARGB, (BYTE*)m_Pixels);
-    this->m_Graphics     = new Gdiplus::Graphics(this->m_Bitmap);
-    m_Graphics->SetPixelOffsetMode(Gdiplus::PixelOffsetModeHighQuality);
-    m_Graphics->SetCompositingMode(Gdiplus::CompositingModeSourceOver);
-    m_Graphics->SetCompositingQuality(Gdiplus::CompositingQualityHighQuality);
-    m_Graphics->SetSmoothingMode(Gdiplus::SmoothingModeAntiAlias);
-    m_Graphics->SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
-    m_Graphics->SetTextRenderingHint(Gdiplus::TextRenderingHintClearTypeGridFit);
+    // Gdiplus, canvases and rendered bitmaps are shared with every other manager..
+    GdiRuntime::Get()->Attach();
+    m_RasterCache = GdiRuntime::Get()->GetRasterCache();
+    m_Textures    = new TextureTracker();
+    m_StagingRing = StagingRing::Attach(pDevice);
     setlocale(LC_ALL, "");
 }
 
 GdiFontManager::~GdiFontManager()
 {
-    delete this->m_Graphics;
-    delete this->m_Bitmap;
-    free(m_RawImage);
-    Gdiplus::GdiplusShutdown(m_GDIToken);
+    CancelPrewarm();
+    for (auto pBlock : m_TextBlocks)
+        delete pBlock;
+    for (auto pPanel : m_TextPanels)
+        delete pPanel;
+    ReleaseNineSlices();
+    delete m_DiskCache;
+    delete m_Textures;
+    m_StagingRing->Detach();
+    GdiRuntime::Get()->Detach();
+}
+
+uint32_t GdiFontManager::RegisterFontFamily(const char* family)
+{
+    auto iter = m_FontFamilyIds.find(family);
+    if (iter != m_FontFamilyIds.end())
+        return iter->second;
+
+    wchar_t wBuffer[256];
+    if (::MultiByteToWideChar(CP_UTF8, 0, family, -1, wBuffer, 256) == 0)
+        return 0;
+    if (GdiRuntime::Get()->GetFontFamily(wBuffer) == nullptr)
+        return 0;
+
+    m_FontFamilyNames.push_back(wBuffer);
+    m_FontIdentities.push_back(GetFontIdentity(wBuffer));
+    auto id                 = (uint32_t)m_FontFamilyNames.size();
+    m_FontFamilyIds[family] = id;
+    return id;
+}
+
+// Families tried in order for code units the primary has no glyph for, a count of zero removes them..
+bool GdiFontManager::SetFontFallbacks(uint32_t familyId, const uint32_t* pFallbackIds, uint32_t count)
+{
+    if ((familyId == 0) || (familyId > m_FontFamilyNames.size()) || (count > GdiMaxFontFallbacks))
+        return false;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if ((pFallbackIds[i] == 0) || (pFallbackIds[i] > m_FontFamilyNames.size()) || (pFallbackIds[i] == familyId))
+            return false;
+    }
+
+    if (count == 0)
+        m_FontFallbacks.erase(familyId);
+    else
+        m_FontFallbacks[familyId].assign(pFallbackIds, pFallbackIds + count);
+    return true;
+}
+
+// Writes the names of a family and its fallbacks, returns how many..
+uint32_t GdiFontManager::GetFontChainNames(uint32_t familyId, const std::wstring** ppNames)
+{
+    uint32_t count = 0;
+    ppNames[count++] = &m_FontFamilyNames[familyId - 1];
+    auto fallbacks   = m_FontFallbacks.find(familyId);
+    if (fallbacks != m_FontFallbacks.end())
+    {
+        for (auto id : fallbacks->second)
+            ppNames[count++] = &m_FontFamilyNames[id - 1];
+    }
+    return count;
+}
+
+// Looks up the calling thread's families for a chain, fallbacks that can't be found are left out..
+bool GdiFontManager::GetFontChain(const std::wstring* const* ppNames, uint32_t count, FontChain_t* pChain)
+{
+    const std::wstring* found[GdiMaxFontFallbacks + 1];
+    pChain->Count = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        auto pFontFamily = GdiRuntime::Get()->GetFontFamily(*ppNames[i]);
+        if (pFontFamily == nullptr)
+        {
+            if (i == 0)
+                return false;
+            continue;
+        }
+        found[pChain->Count]              = ppNames[i];
+        pChain->Families[pChain->Count++] = pFontFamily;
+    }
+
+    // Coverage is only needed to choose between fonts..
+    for (uint32_t i = 0; (pChain->Count > 1) && (i < pChain->Count); i++)
+        pChain->Coverage[i] = FontIndex::Get()->GetCoverage(*found[i]);
+    return true;
+}
+
+uint64_t GdiFontManager::HashFontRequest(const GdiFontDesc_t& data, int32_t boxWidth, int32_t boxHeight)
+{
+    auto hash = HashValue(m_FontIdentities[data.FontFamilyId - 1], HashSeed);
+    hash      = HashBytes(data.FontText, data.FontTextLength, hash);
+    hash      = HashValue(boxWidth, hash);
+    hash      = HashValue(boxHeight, hash);
+    hash      = HashValue(data.FontHeight, hash);
+    hash      = HashValue(data.OutlineWidth, hash);
+    hash      = HashValue(data.FontFlags, hash);
+    hash      = HashValue(data.FontColor, hash);
+    hash      = HashValue(data.OutlineColor, hash);
+    hash      = HashValue(data.GradientStyle, hash);
+    hash      = HashValue(data.GradientColor, hash);
+    hash      = HashValue(m_DilatedOutline, hash);
+
+    // Fallback fonts change which glyphs are drawn..
+    auto fallbacks = m_FontFallbacks.find(data.FontFamilyId);
+    if (fallbacks != m_FontFallbacks.end())
+    {
+        for (auto id : fallbacks->second)
+            hash = HashValue(m_FontIdentities[id - 1], hash);
+    }
+    return hash;
+}
+
+GdiFontReturnEx_t GdiFontManager::CreateFontTexture(const GdiFontData_t& data)
+{
+    GdiFontDesc_t desc;
+    desc.FontText       = data.FontText;
+    desc.FontTextLength = (uint32_t)strnlen(data.FontText, sizeof(data.FontText));
+    desc.FontFamilyId   = RegisterFontFamily(data.FontFamily);
+    desc.BoxHeight      = data.BoxHeight;
+    desc.BoxWidth       = data.BoxWidth;
+    desc.FontHeight     = data.FontHeight;
+    desc.OutlineWidth   = data.OutlineWidth;
+    desc.FontFlags      = data.FontFlags;
+    desc.FontColor      = data.FontColor;
+    desc.OutlineColor   = data.OutlineColor;
+    desc.GradientStyle  = data.GradientStyle;
+    desc.GradientColor  = data.GradientColor;
+    return CreateFontTexture(desc, nullptr);
+}
+
+GdiFontReturnEx_t GdiFontManager::CreateFontTexture(const GdiFontDesc_t& data, const GdiGradient_t* pGradient)
+{
+    GdiTextDesc_t desc{};
+    desc.Font     = data;
+    desc.Gradient = pGradient;
+    return CreateTextTexture(desc);
+}
+
+GdiFontReturnEx_t GdiFontManager::CreateTextTexture(const GdiTextDesc_t& desc)
+{
+    return CreateText(desc, false);
+}
+
+GdiFontReturnEx_t GdiFontManager::CreateMarkupTexture(const GdiTextDesc_t& desc)
+{
+    return CreateText(desc, true);
+}
+
+TextBlock* GdiFontManager::CreateTextBlock(const GdiTextDesc_t& style, uint32_t capacity, bool markup)
+{
+    if ((style.Font.FontFamilyId == 0) || (style.Font.FontFamilyId > m_FontFamilyNames.size()))
+        return nullptr;
+
+    auto pBlock = new TextBlock(this, style, capacity, markup);
+    m_TextBlocks.push_back(pBlock);
+    return pBlock;
+}
+
+void GdiFontManager::DestroyTextBlock(TextBlock* pBlock)
+{
+    for (auto iter = m_TextBlocks.begin(); iter != m_TextBlocks.end(); iter++)
+    {
+        if (*iter == pBlock)
+        {
+            m_TextBlocks.erase(iter);
+            delete pBlock;
+            return;
+        }
+    }
+}
+
+// Panels are as wide as the style's box and one line pitch tall per line, the pitch leaves room for the outline..
+TextPanel* GdiFontManager::CreateTextPanel(const GdiFontDesc_t& style, uint32_t lineCount)
+{
+    auto spacing = GetLineSpacing(style.FontFamilyId, style.FontFlags, style.FontHeight);
+    if ((spacing <= 0.0f) || (lineCount == 0))
+        return nullptr;
+
+    auto width  = (style.BoxWidth == 0) ? m_CanvasWidth : style.BoxWidth;
+    auto pitch  = (int32_t)ceil(spacing + style.OutlineWidth);
+    auto height = pitch * (int32_t)lineCount;
+    if ((width > m_CanvasWidth) || (height > m_CanvasHeight))
+        return nullptr;
+
+    // Managed so single slots can be locked, the driver only uploads the dirty part..
+    IDirect3DTexture8* pTexture;
+    if (FAILED(::D3DXCreateTexture(m_Device, width, height, 1, 0, m_TextureFormat, D3DPOOL_MANAGED, &pTexture)))
+        return nullptr;
+    D3DLOCKED_RECT rect{};
+    D3DSURFACE_DESC surfaceDesc;
+    if (FAILED(pTexture->GetLevelDesc(0, &surfaceDesc)) || FAILED(pTexture->LockRect(0, &rect, nullptr, 0)))
+    {
+        pTexture->Release();
+        return nullptr;
+    }
+    memset(rect.pBits, 0, (size_t)rect.Pitch * surfaceDesc.Height);
+    pTexture->UnlockRect(0);
+
+    // The tracker takes its own reference, the panel owns the one from creation..
+    m_Textures->Track(pTexture, D3DPOOL_MANAGED, width, height, std::vector<uint8_t>());
+    UpdateMemoryStats(nullptr);
+
+    auto pPanel = new TextPanel(this, style, pTexture, width, pitch, lineCount);
+    m_TextPanels.push_back(pPanel);
+    return pPanel;
+}
+
+void GdiFontManager::DestroyTextPanel(TextPanel* pPanel)
+{
+    for (auto iter = m_TextPanels.begin(); iter != m_TextPanels.end(); iter++)
+    {
+        if (*iter == pPanel)
+        {
+            m_TextPanels.erase(iter);
+            delete pPanel;
+            return;
+        }
+    }
 }
 
-GdiFontReturn_t GdiFontManager::CreateFontTexture(GdiFontData_t data)
+// Clears one slot of a panel texture and writes a line into it, clipped to the slot. Lines are cached with their
+// left margin so they land where a full render would have put them..
+bool GdiFontManager::DrawPanelLine(IDirect3DTexture8* pTexture, const GdiFontDesc_t& style, const char* text, uint32_t length, int32_t top, int32_t width, int32_t pitch, int32_t* pWidth, int32_t* pHeight)
 {
-    if (data.BoxHeight == 0)
-        data.BoxHeight = m_CanvasHeight;
-    if (data.BoxWidth == 0)
-        data.BoxWidth = m_CanvasWidth;
+    D3DSURFACE_DESC surfaceDesc;
+    BlitFormat blitFormat;
+    if (FAILED(pTexture->GetLevelDesc(0, &surfaceDesc)) || !GetBlitFormat(surfaceDesc.Format, &blitFormat))
+        return false;
+
+    auto written = false;
+    auto write   = [&](const uint8_t* pixels, int32_t sourcePitch, int32_t sourceWidth, int32_t sourceHeight) {
+        RECT slot = {0, top, width, top + pitch};
+        D3DLOCKED_RECT rect{};
+        if (FAILED(pTexture->LockRect(0, &rect, &slot, 0)))
+            return;
+
+        auto rowBytes = width * GetBytesPerPixel(blitFormat);
+        for (int32_t y = 0; y < pitch; y++)
+            memset((uint8_t*)rect.pBits + (y * rect.Pitch), 0, rowBytes);
+
+        sourceWidth  = (sourceWidth > width) ? width : sourceWidth;
+        sourceHeight = (sourceHeight > pitch) ? pitch : sourceHeight;
+        if (pixels)
+        {
+            uint32_t flags = BlitFlagNone;
+            if (m_Premultiply)
+                flags |= BlitFlagPremultiply;
+            if (m_Dither)
+                flags |= BlitFlagDither;
+            BlitPixels((uint8_t*)rect.pBits, rect.Pitch, pixels, sourcePitch, sourceWidth, sourceHeight, blitFormat, flags, false);
+        }
+        pTexture->UnlockRect(0);
+        *pWidth  = pixels ? sourceWidth : 0;
+        *pHeight = pixels ? sourceHeight : 0;
+        written  = true;
+    };
+
+    // Empty lines only clear their slot..
+    if (length == 0)
+    {
+        write(nullptr, 0, 0, 0);
+        return written;
+    }
 
-    // Attempt to set up font family..
-    wchar_t wBuffer[4096];
-    ::MultiByteToWideChar(CP_UTF8, 0, data.FontFamily, -1, wBuffer, 4096);
-    Gdiplus::FontFamily* pFontFamily = new Gdiplus::FontFamily(wBuffer);
-    if (pFontFamily->GetLastStatus() != Gdiplus::Ok)
+    auto data           = style;
+    data.FontText       = text;
+    data.FontTextLength = length;
+    auto cacheKey       = HashValue(PanelLineSalt, HashFontRequest(data, width, pitch));
+    if (m_RasterCache->Find(cacheKey, write))
+        return written;
+
+    if (m_TextBuffer.size() < length)
+        m_TextBuffer.resize(length);
+    auto wideLength = (INT)Utf8ToUtf16(text, length, (uint16_t*)m_TextBuffer.data());
+    const std::wstring* names[GdiMaxFontFallbacks + 1];
+    FontChain_t chain;
+    if ((wideLength == 0) || !GetFontChain(names, GetFontChainNames(data.FontFamilyId, names), &chain))
+        return false;
+
+    GdiTextDesc_t desc{};
+    desc.Font = data;
+    CanvasLease canvas;
+    CanvasRegion_t region;
+    if (!RenderFont(canvas.Get(), chain, desc, m_TextBuffer.data(), wideLength, width, pitch, false, &region))
     {
-        delete pFontFamily;
-        return GdiFontReturn_t();
+        // Nothing visible, such as a line of spaces..
+        write(nullptr, 0, 0, 0);
+        return written;
     }
 
-    // Attempt to create graphics path..
-    ::MultiByteToWideChar(CP_UTF8, 0, data.FontText, -1, wBuffer, 4096);
-    auto length = wcslen(wBuffer);
-    Gdiplus::Rect pathRect(0, 0, data.BoxWidth, data.BoxHeight);
-    Gdiplus::StringFormat fontFormat;
-    fontFormat.SetAlignment(Gdiplus::StringAlignment::StringAlignmentNear);
+    // Widen the trimmed region back out to the left edge of the canvas..
+    auto left = (int32_t)((region.Pixels - canvas->GetPixels()) / 4);
+    m_RasterCache->Insert(cacheKey, region.Width + left, region.Height, region.Pixels - (left * 4), region.Pitch);
+    write(region.Pixels - (left * 4), region.Pitch, region.Width + left, region.Height);
+    return written;
+}
+
+// Everything DrawPanelLine reads besides the line itself, the panel format is fixed when it is created..
+uint64_t GdiFontManager::HashPanelSettings(uint64_t seed) const
+{
+    auto hash = HashValue(m_Premultiply, seed);
+    return HashValue(m_Dither, hash);
+}
+
+// Distance between baselines for the primary family, zero if it isn't registered..
+float GdiFontManager::GetLineSpacing(uint32_t familyId, int32_t flags, float height)
+{
+    if ((familyId == 0) || (familyId > m_FontFamilyNames.size()))
+        return 0.0f;
+
+    auto pFamily = GdiRuntime::Get()->GetFontFamily(m_FontFamilyNames[familyId - 1]);
+    if (pFamily == nullptr)
+        return 0.0f;
+
+    float ascent, lineSpacing;
+    GetFontMetrics(pFamily, flags, height, &ascent, &lineSpacing);
+    return lineSpacing;
+}
+
+GdiFontReturnEx_t GdiFontManager::CreateText(const GdiTextDesc_t& desc, bool markup)
+{
+    auto& data     = desc.Font;
+    auto boxHeight = (data.BoxHeight == 0) ? m_CanvasHeight : data.BoxHeight;
+    auto boxWidth  = (data.BoxWidth == 0) ? m_CanvasWidth : data.BoxWidth;
+
+    // Look up interned font family..
+    if ((data.FontFamilyId == 0) || (data.FontFamilyId > m_FontFamilyNames.size()))
+        return GdiFontReturnEx_t();
+
+    // Serve from memory if this exact request was prewarmed or rendered recently..
+    auto cacheKey = HashFontRequest(data, boxWidth, boxHeight);
+    if (markup)
+        cacheKey = HashValue(markup, cacheKey);
+    if (desc.Gradient)
+        cacheKey = HashGradient(*desc.Gradient, cacheKey);
+    if (((desc.Shadow.Color | desc.Glow.Color) & 0xFF000000) != 0)
+    {
+        cacheKey = HashTextEffect(desc.Shadow, cacheKey);
+        cacheKey = HashTextEffect(desc.Glow, cacheKey);
+    }
+    GdiFontReturnEx_t ret;
+    auto upload = [&](const uint8_t* pixels, int32_t pitch, int32_t width, int32_t height) {
+        ret = CreateTextureFromCanvas(pixels, pitch, width, height);
+        if ((ret.Texture != nullptr) && m_SaveToHardDrive)
+            SaveTextureDump(pixels, pitch, width, height, L"font");
+    };
+    if (m_RasterCache->Find(cacheKey, upload))
+        return ret;
+
+    // Serve from the disk cache if it was rendered with the same font file in an earlier session..
+    if (m_DiskCache)
+    {
+        CanvasRegion_t cached;
+        if (m_DiskCache->Find(cacheKey, &cached.Width, &cached.Height, &cached.Pixels))
+        {
+            m_RasterCache->Insert(cacheKey, cached.Width, cached.Height, cached.Pixels, cached.Width * 4);
+            upload(cached.Pixels, cached.Width * 4, cached.Width, cached.Height);
+            return ret;
+        }
+    }
+
+    // Convert text, utf-16 never needs more code units than utf-8 has bytes so a single pass is enough..
+    if (m_TextBuffer.size() < data.FontTextLength)
+        m_TextBuffer.resize(data.FontTextLength);
+    auto length = (INT)Utf8ToUtf16(data.FontText, data.FontTextLength, (uint16_t*)m_TextBuffer.data());
+    if (length == 0)
+        return GdiFontReturnEx_t();
+
+    const std::wstring* names[GdiMaxFontFallbacks + 1];
+    FontChain_t chain;
+    if (!GetFontChain(names, GetFontChainNames(data.FontFamilyId, names), &chain))
+        return GdiFontReturnEx_t();
+
+    CanvasLease canvas;
+    CanvasRegion_t region;
+    if (!RenderFont(canvas.Get(), chain, desc, m_TextBuffer.data(), length, boxWidth, boxHeight, markup, &region))
+        return GdiFontReturnEx_t();
+
+    // Keep trimmed pixels around so repeats and later sessions can skip rendering..
+    StoreRaster(cacheKey, region);
+
+    // Attempt to create texture and copy rendered font into it..
+    upload(region.Pixels, region.Pitch, region.Width, region.Height);
+    return ret;
+}
+
+bool GdiFontManager::RenderFont(GdiCanvas* pCanvas, const FontChain_t& chain, const GdiTextDesc_t& desc, const wchar_t* text, INT length, int32_t boxWidth, int32_t boxHeight, bool markup, CanvasRegion_t* pRegion)
+{
+    auto& data     = desc.Font;
+    auto pGradient = desc.Gradient;
+
+    // Effects pad the text on each side by as far as they reach, the shadow of an outline includes the outline..
+    const GdiTextEffect_t* effects[2] = { &desc.Shadow, &desc.Glow };
+    auto outline                      = (data.OutlineWidth > 0) && ((data.OutlineColor & 0xFF000000) != 0);
+    auto grow                         = outline ? (data.OutlineWidth * 0.5f) : 0.0f;
+    auto hasEffects                   = false;
+    int32_t padLeft                   = 0;
+    int32_t padTop                    = 0;
+    int32_t padRight                  = 0;
+    int32_t padBottom                 = 0;
+    for (auto pEffect : effects)
+    {
+        if ((pEffect->Color & 0xFF000000) == 0)
+            continue;
+        auto reach = GetTextEffectReach(*pEffect, grow);
+        if ((reach - pEffect->OffsetX) > padLeft)
+            padLeft = reach - pEffect->OffsetX;
+        if ((reach - pEffect->OffsetY) > padTop)
+            padTop = reach - pEffect->OffsetY;
+        if ((reach + pEffect->OffsetX) > padRight)
+            padRight = reach + pEffect->OffsetX;
+        if ((reach + pEffect->OffsetY) > padBottom)
+            padBottom = reach + pEffect->OffsetY;
+        hasEffects = true;
+    }
+
+    // Attempt to create graphics path, markup also keeps a path per fill color..
+    Gdiplus::Rect pathRect(padLeft, padTop, boxWidth, boxHeight);
     Gdiplus::GraphicsPath* pPath = new Gdiplus::GraphicsPath();
-    pPath->AddString(wBuffer, length, pFontFamily, data.FontFlags, data.FontHeight, pathRect, &fontFormat);
+    std::vector<MarkupLayer_t> layers;
+    if (markup)
+        AddMarkupString(pPath, &layers, pCanvas->GetGraphics(), chain, text, length, data, (float)padLeft, (float)padTop);
+    else if ((chain.Count < 2) || !AddFallbackString(pPath, pCanvas->GetGraphics(), chain, text, length, data.FontFlags, data.FontHeight, (float)padLeft, (float)padTop))
+        pPath->AddString(text, length, chain.Families[0], data.FontFlags, data.FontHeight, pathRect, GdiRuntime::Get()->GetStringFormat());
     if (pPath->GetLastStatus() != Gdiplus::Ok)
     {
+        for (auto& layer : layers)
+            delete layer.Path;
         delete pPath;
-        delete pFontFamily;
-        return GdiFontReturn_t();
+        return false;
     }
 
     // Prepare outline pen if applicable and get calculated path size from Gdiplus..
     Gdiplus::Pen* pen = nullptr;
     Gdiplus::RectF box{};
-    if ((data.OutlineWidth > 0) && ((data.OutlineColor & 0xFF000000) != 0))
+    if (outline)
     {
         pen = new Gdiplus::Pen(UINT32_TO_COLOR(data.OutlineColor), data.OutlineWidth);
         pPath->GetBounds(&box, nullptr, pen);
@@ -129,170 +822,132 @@ GdiFontReturn_t GdiFontManager::CreateFontTexture(GdiFontData_t data)
     // Clear necessary space using calculated path size.
     int32_t width  = (int32_t)ceil(box.Width);
     int32_t height = (int32_t)ceil(box.Height);
-    this->ClearCanvas(width, height);
-
-    // Draw outline if applicable..
-    if (pen)
+    if (hasEffects || markup)
+    {
+        width  = (int32_t)ceil(box.GetRight()) + padRight;
+        height = (int32_t)ceil(box.GetBottom()) + padBottom;
+    }
+    if (width > pCanvas->GetWidth())
+        width = pCanvas->GetWidth();
+    if (height > pCanvas->GetHeight())
+        height = pCanvas->GetHeight();
+    pCanvas->Clear(width, height);
+    auto pGraphics = pCanvas->GetGraphics();
+
+    // Gradient fills are drawn as a white coverage mask first and colored from a ramp once the outline is down..
+    auto fill     = (pGradient != nullptr) || ((data.FontColor & 0xFF000000) != 0) || ((data.GradientStyle != 0) && ((data.GradientColor & 0xFF000000) != 0)) || !layers.empty();
+    auto gradient = fill && ((pGradient != nullptr) || (data.GradientStyle != 0));
+
+    // Dilated outlines grow the fill mask instead of stroking, so they need a fill to sit under..
+    auto dilate = (pen != nullptr) && fill && m_DilatedOutline;
+
+    // Scratch is allocated before anything is drawn, so running out of memory abandons the render cleanly..
+    auto spreads = dilate;
+    for (auto pEffect : effects)
+        spreads = spreads || (((pEffect->Color & 0xFF000000) != 0) && ((pEffect->Spread > 0.0f) || (grow > 0.0f)));
+    uint32_t planes = (gradient || dilate || hasEffects) ? 1 : 0;
+    planes          = (dilate || hasEffects) ? 2 : planes;
+    planes          = hasEffects ? 3 : planes;
+    auto ready      = !spreads || (pCanvas->GetDistances() != nullptr);
+    for (uint32_t plane = 0; ready && (plane < planes); plane++)
+        ready = pCanvas->GetMask(plane) != nullptr;
+    if (!ready)
     {
-        m_Graphics->DrawPath(pen, pPath);
         delete pen;
+        for (auto& layer : layers)
+            delete layer.Path;
+        delete pPath;
+        return false;
     }
 
-    // Fill text if font color isn't fully transparent..
-    if (((data.FontColor & 0xFF000000) != 0) || ((data.GradientStyle != 0) && ((data.GradientColor & 0xFF000000) != 0)))
+    if (gradient || dilate || hasEffects)
     {
-        auto pBrush = GetBrush(data, width, height);
-        m_Graphics->FillPath(pBrush, pPath);
-        delete pBrush;
+        Gdiplus::SolidBrush maskBrush(Gdiplus::Color(255, 255, 255, 255));
+        pGraphics->FillPath(&maskBrush, pPath);
+        BlitPixels(pCanvas->GetMask(0), width, pCanvas->GetPixels(), pCanvas->GetStride(), width, height, BlitFormat::A8, BlitFlagNone, false);
+        pCanvas->Clear(width, height);
     }
 
-    // Clean up remaining gdiplus objects..
-    delete pPath;
-    delete pFontFamily;
-
-    // Examine raw pixels to get exact texture size(gdiplus does not calculate pixel perfect size)..
-    int32_t firstPx = width - 1;
-    int32_t lastPx  = 0;
-    uint32_t* px    = (uint32_t*)this->m_Pixels;
-    int maxHeight   = height;
-    for (auto y = 0; y < maxHeight; y++)
+    // Draw shadow and glow beneath everything else..
+    for (auto pEffect : effects)
     {
-        for (auto x = (width - 1); x >= lastPx; x--)
-        {
-            if (px[x])
-            {
-                height = y + 1;
-                lastPx = x;
-            }
-        }
-
-        for (auto x = 0; x < width; x++)
-        {
-            if (px[x])
-            {
-                height = y + 1;
-                if (x < firstPx)
-                {
-                    firstPx = x;
-                }
-                break;
-            }
-        }
-
-        px += this->m_CanvasWidth;
+        if ((pEffect->Color & 0xFF000000) != 0)
+            DrawTextEffect(pCanvas, *pEffect, grow, width, height);
     }
-    width = (lastPx - firstPx) + 1;
 
-    // End early if width or height are 0..
-    if ((width == 0) || (height == 0))
-        return GdiFontReturn_t();
-
-    // Attempt to create texture..
-    IDirect3DTexture8* pTexture;
-    if (FAILED(::D3DXCreateTexture(this->m_Device, width, height, 1, 0, D3DFMT_A8R8G8B8, D3DPOOL_MANAGED, &pTexture)))
+    // Draw outline if applicable..
+    GradientShape_t shape;
+    uint32_t lut[GradientLutSize];
+    if (dilate)
     {
-        return GdiFontReturn_t();
+        // The pen is centered on the edge, so the outline reaches half its width past the fill..
+        DilateMask(pCanvas->GetMask(1), width, pCanvas->GetMask(0), width, width, height, data.OutlineWidth * 0.5f, pCanvas->GetDistances());
+        BuildGradientLut(data.OutlineColor, data.OutlineColor, lut);
+        GetGradientLine(0, width, height, &shape);
+        CompositeGradient(pCanvas->GetPixels(), pCanvas->GetStride(), pCanvas->GetMask(1), width, width, height, lut, shape);
     }
-    D3DSURFACE_DESC surfaceDesc;
-    if (FAILED(pTexture->GetLevelDesc(0, &surfaceDesc)))
+    else if (pen)
     {
-        if (pTexture != nullptr)
-            pTexture->Release();
-
-        return GdiFontReturn_t();
+        pGraphics->DrawPath(pen, pPath);
     }
+    delete pen;
 
-    // Copy rendered font from bitmap to texture..
-    D3DLOCKED_RECT rect{};
-    auto copyStride = width * 4;
-    pTexture->LockRect(0, &rect, 0, 0);
+    // Fill text if font color isn't fully transparent..
+    if (gradient)
     {
-        uint8_t* dest = (uint8_t*)rect.pBits;
-        uint8_t* src  = this->m_Pixels + (firstPx * 4);
-        for (int x = 0; x < height; x++)
+        // Ramps for gradient descriptors are cached, only the render thread passes one..
+        const uint32_t* pRamp = lut;
+        if (pGradient)
         {
-            memcpy(dest, src, copyStride);
-            dest += copyStride;
-            src += this->m_CanvasStride;
+            pRamp = GetGradientRamp(*pGradient);
+            GetGradientShape(*pGradient, width, height, &shape);
         }
-    }
-    pTexture->UnlockRect(0);
-
-    // Save physical file if requested
-    if (m_SaveToHardDrive)
-    {
-        BITMAPV4HEADER bmp   = {sizeof(BITMAPV4HEADER)};
-        bmp.bV4Width         = width;
-        bmp.bV4Height        = height;
-        bmp.bV4Planes        = 1;
-        bmp.bV4BitCount      = 32;
-        bmp.bV4V4Compression = BI_BITFIELDS;
-        bmp.bV4RedMask       = 0x00FF0000;
-        bmp.bV4GreenMask     = 0x0000FF00;
-        bmp.bV4BlueMask      = 0x000000FF;
-        bmp.bV4AlphaMask     = 0xFF000000;
-
-        uint8_t* pPixels      = nullptr;
-        HBITMAP pBmp          = ::CreateDIBSection(nullptr, (BITMAPINFO*)&bmp, DIB_RGB_COLORS, (void**)&pPixels, nullptr, 0);
-        Gdiplus::Bitmap* pRaw = new Gdiplus::Bitmap(width, height, width * 4, PixelFormat32bppARGB, (BYTE*)pPixels);
-
-        uint8_t* src = this->m_Pixels + (firstPx * 4);
-        for (int x = 0; x < height; x++)
+        else
         {
-            memcpy(pPixels, src, copyStride);
-            pPixels += copyStride;
-            src += this->m_CanvasStride;
+            BuildGradientLut(data.FontColor, data.GradientColor, lut);
+            GetGradientLine(data.GradientStyle, width, height, &shape);
         }
-
-        CLSID pngClsid;
-        GetEncoderClsid(L"image/png", &pngClsid);
-        auto index = 0;
-        wchar_t nameBuffer[256];
-        swprintf_s(nameBuffer, L"%S\\font_%u.png", m_SavePath, index);
-        while (std::filesystem::exists(nameBuffer))
+        CompositeGradient(pCanvas->GetPixels(), pCanvas->GetStride(), pCanvas->GetMask(0), width, width, height, pRamp, shape);
+    }
+    else if (markup)
+    {
+        // Color tags only apply to solid fills, a gradient covers every run..
+        for (auto& layer : layers)
         {
-            index++;
-            swprintf_s(nameBuffer, L"%S\\font_%u.png", m_SavePath, index);
+            if ((layer.Color & 0xFF000000) == 0)
+                continue;
+            Gdiplus::SolidBrush brush(UINT32_TO_COLOR(layer.Color));
+            pGraphics->FillPath(&brush, layer.Path);
         }
-        pRaw->Save(nameBuffer, &pngClsid, NULL);
-        delete pRaw;
-        DeleteObject(pBmp);
     }
-
-    // Create return object..
-    GdiFontReturn_t ret;
-    ret.Width   = width;
-    ret.Height  = height;
-    ret.Texture = pTexture;
-    return ret;
-}
-Gdiplus::GraphicsPath* CreateRoundedRectPath(Gdiplus::Rect rect, int radius)
-{
-    Gdiplus::GraphicsPath* pPath = new Gdiplus::GraphicsPath();
-    if (radius == 0)
-        pPath->AddRectangle(rect);
-    else
+    else if (dilate)
     {
-        int diameter = radius * 2;
-        Gdiplus::Rect arc(rect.X, rect.Y, diameter, diameter);
-        pPath->AddArc(arc, 180, 90);
-        arc.X = (rect.X + rect.Width) - diameter;
-        pPath->AddArc(arc, 270, 90);
-        arc.Y = (rect.Y + rect.Height) - diameter;
-        pPath->AddArc(arc, 0, 90);
-        arc.X = rect.X;
-        pPath->AddArc(arc, 90, 90);
-        pPath->CloseFigure();
+        BuildGradientLut(data.FontColor, data.FontColor, lut);
+        CompositeGradient(pCanvas->GetPixels(), pCanvas->GetStride(), pCanvas->GetMask(0), width, width, height, lut, shape);
     }
-    return pPath;
+    else if (fill)
+    {
+        Gdiplus::SolidBrush brush(UINT32_TO_COLOR(data.FontColor));
+        pGraphics->FillPath(&brush, pPath);
+    }
+
+    // Clean up remaining gdiplus objects..
+    for (auto& layer : layers)
+        delete layer.Path;
+    delete pPath;
+
+    return pCanvas->Trim(width, height, pRegion);
 }
 
-GdiFontReturn_t GdiFontManager::CreateRectTexture(GdiRectData_t data)
+GdiFontReturnEx_t GdiFontManager::CreateRectTexture(const GdiRectData_t& data, const GdiGradient_t* pGradient)
 {
     int width  = data.Width;
     int height = data.Height;
 
-    Gdiplus::Rect drawRect(0, 0, width, height);
+    // The outline is centered on the edge, so the edge is inset to keep the outline inside the texture..
+    RoundedRect_t rect{};
+    rect.Right  = (float)width;
+    rect.Bottom = (float)height;
     if (data.OutlineWidth != 0)
     {
         auto inset  = data.OutlineWidth / 2;
@@ -302,268 +957,664 @@ GdiFontReturn_t GdiFontManager::CreateRectTexture(GdiRectData_t data)
             inset += 1;
             shrink++;
         }
-        drawRect = Gdiplus::Rect(inset, inset, width - shrink, height - shrink);
+        rect.Left   = (float)inset;
+        rect.Top    = (float)inset;
+        rect.Right  = (float)(inset + width - shrink);
+        rect.Bottom = (float)(inset + height - shrink);
     }
-    Gdiplus::GraphicsPath* pPath = CreateRoundedRectPath(drawRect, data.Diameter);
-
-    // Clear necessary space
-    this->ClearCanvas(width, height);
+    rect.Radius = (float)data.Diameter;
 
-    // Fill text if font color isn't fully transparent..
-    if (((data.FillColor & 0xFF000000) != 0) || ((data.GradientStyle != 0) && ((data.GradientColor & 0xFF000000) != 0)))
+    // Fill if fill color isn't fully transparent..
+    uint32_t lut[GradientLutSize];
+    if (pGradient)
+    {
+        rect.FillRamp = GetGradientRamp(*pGradient);
+        GetGradientShape(*pGradient, width, height, &rect.FillShape);
+    }
+    else if (((data.FillColor & 0xFF000000) != 0) || ((data.GradientStyle != 0) && ((data.GradientColor & 0xFF000000) != 0)))
     {
-        auto pBrush = GetBrush(data, width, height);
-        m_Graphics->FillPath(pBrush, pPath);
-        delete pBrush;
+        rect.FillColor = data.FillColor;
+        if (data.GradientStyle != 0)
+        {
+            BuildGradientLut(data.FillColor, data.GradientColor, lut);
+            GetGradientLine(data.GradientStyle, width, height, &rect.FillShape);
+            rect.FillRamp = lut;
+        }
     }
 
     // Draw outline if applicable..
     if ((data.OutlineWidth > 0) && ((data.OutlineColor & 0xFF000000) != 0))
     {
-        Gdiplus::GraphicsPath* pOutline = CreateRoundedRectPath(drawRect, data.Diameter);
-        Gdiplus::Pen pen(UINT32_TO_COLOR(data.OutlineColor), data.OutlineWidth);
-        m_Graphics->DrawPath(&pen, pOutline);
-        delete pOutline;
+        rect.OutlineWidth = (float)data.OutlineWidth;
+        rect.OutlineColor = data.OutlineColor;
     }
 
-    // Clean up remaining gdiplus objects..
-    delete pPath;
+    // Fill and outline are rasterized in one pass straight into the canvas..
+    CanvasLease canvas;
+    RasterizeRoundedRect(canvas->GetPixels(), canvas->GetStride(), width, height, rect);
 
-    // Attempt to create texture..
-    IDirect3DTexture8* pTexture;
-    if (FAILED(::D3DXCreateTexture(this->m_Device, width, height, 1, 0, D3DFMT_A8R8G8B8, D3DPOOL_MANAGED, &pTexture)))
+    // Attempt to create texture and copy rendered rect into it..
+    GdiFontReturnEx_t ret = CreateTextureFromCanvas(canvas->GetPixels(), canvas->GetStride(), width, height);
+    if (ret.Texture == nullptr)
+        return ret;
+
+    // Save physical file if requested
+    if (m_SaveToHardDrive)
+        SaveTextureDump(canvas->GetPixels(), canvas->GetStride(), width, height, L"rect");
+
+    return ret;
+}
+
+GdiFontReturnEx_t GdiFontManager::CreateNineSliceRectTexture(const GdiRectData_t& data, GdiNineSlice_t* pSlice)
+{
+    *pSlice = GdiNineSlice_t{};
+
+    // Corners hold the arc and the outline plus a pixel of anti-aliasing, the middle is two pixels that stretch..
+    auto inset  = (int32_t)((data.OutlineWidth / 2) + (data.OutlineWidth % 2));
+    auto border = inset + ((data.Diameter > 0) ? data.Diameter : 0) + (int32_t)((data.OutlineWidth + 1) / 2) + 1;
+    auto size   = (border * 2) + 2;
+
+    // Gradients change across the stretched middle and small rects gain nothing, render those in full..
+    if ((data.GradientStyle != 0) || (data.Width <= size) || (data.Height <= size))
+        return CreateRectTexture(data, nullptr);
+
+    // Only the look matters for the key, any panel size with the same style shares the texture..
+    auto key = HashValue(data.Diameter, HashSeed);
+    key      = HashValue(data.OutlineColor, key);
+    key      = HashValue(data.OutlineWidth, key);
+    key      = HashValue(data.FillColor, key);
+    key      = HashTextureSettings(key);
+
+    auto iter = m_NineSlices.find(key);
+    if (iter == m_NineSlices.end())
     {
-        return GdiFontReturn_t();
+        GdiRectData_t sliceData = data;
+        sliceData.Width         = size;
+        sliceData.Height        = size;
+        auto ret                = CreateRectTexture(sliceData, nullptr);
+        if (ret.Texture == nullptr)
+            return ret;
+        iter = m_NineSlices.emplace(key, ret).first;
     }
-    D3DSURFACE_DESC surfaceDesc;
-    if (FAILED(pTexture->GetLevelDesc(0, &surfaceDesc)))
+    else
     {
-        if (pTexture != nullptr)
-            pTexture->Release();
-
-        return GdiFontReturn_t();
+        // Every holder of the handle can claim the texture rebuilt after a reset..
+        m_Textures->Share(iter->second.Handle);
     }
 
-    // Copy rendered font from bitmap to texture..
-    D3DLOCKED_RECT rect{};
-    auto copyStride = width * 4;
-    pTexture->LockRect(0, &rect, 0, 0);
-    {
-        uint8_t* dest = (uint8_t*)rect.pBits;
-        uint8_t* src  = this->m_Pixels;
-        for (int x = 0; x < height; x++)
-        {
-            memcpy(dest, src, copyStride);
-            dest += copyStride;
-            src += this->m_CanvasStride;
-        }
-    }
-    pTexture->UnlockRect(0);
+    // The cache keeps the reference from creation, every caller gets its own..
+    iter->second.Texture->AddRef();
 
-    // Save physical file if requested
-    if (m_SaveToHardDrive)
+    pSlice->Left   = border;
+    pSlice->Top    = border;
+    pSlice->Right  = border;
+    pSlice->Bottom = border;
+    return iter->second;
+}
+
+uint64_t GdiFontManager::HashTextureSettings(uint64_t seed) const
+{
+    // Everything CreateTextureFromCanvas reads, so a texture kept across calls matches what it would create now..
+    auto hash = HashValue(m_TextureFormat, seed);
+    hash      = HashValue(m_TexturePool, hash);
+    hash      = HashValue(m_Premultiply, hash);
+    hash      = HashValue(m_Dither, hash);
+    hash      = HashValue(m_GenerateMipmaps, hash);
+    hash      = HashValue(m_CompressionFormat, hash);
+    hash      = HashValue(m_CompressionThreshold, hash);
+    return HashValue(m_MemoryBudget, hash);
+}
+
+void GdiFontManager::ReleaseNineSlices()
+{
+    for (auto& pair : m_NineSlices)
+        pair.second.Texture->Release();
+    m_NineSlices.clear();
+}
+
+GdiFontReturnEx_t GdiFontManager::CreateTextureFromCanvas(const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height)
+{
+    // Large textures are block compressed if enabled, everything else uses the configured format..
+    auto requestFormat = m_TextureFormat;
+    if ((m_CompressionFormat != D3DFMT_UNKNOWN) && (((uint32_t)width * (uint32_t)height) >= m_CompressionThreshold))
+        requestFormat = m_CompressionFormat;
+
+    // Release a few textures the caller has dropped, a full pass only happens when the budget is at stake..
+    m_Textures->Sweep(32);
+    if (m_MemoryBudget != 0)
     {
-        BITMAPV4HEADER bmp   = {sizeof(BITMAPV4HEADER)};
-        bmp.bV4Width         = width;
-        bmp.bV4Height        = height;
-        bmp.bV4Planes        = 1;
-        bmp.bV4BitCount      = 32;
-        bmp.bV4V4Compression = BI_BITFIELDS;
-        bmp.bV4RedMask       = 0x00FF0000;
-        bmp.bV4GreenMask     = 0x0000FF00;
-        bmp.bV4BlueMask      = 0x000000FF;
-        bmp.bV4AlphaMask     = 0xFF000000;
-
-        uint8_t* pPixels      = nullptr;
-        HBITMAP pBmp          = ::CreateDIBSection(nullptr, (BITMAPINFO*)&bmp, DIB_RGB_COLORS, (void**)&pPixels, nullptr, 0);
-        Gdiplus::Bitmap* pRaw = new Gdiplus::Bitmap(width, height, width * 4, PixelFormat32bppARGB, (BYTE*)pPixels);
-
-        uint8_t* src = this->m_Pixels;
-        for (int x = 0; x < height; x++)
+        auto estimate = EstimateTextureBytes(requestFormat, width, height, m_GenerateMipmaps);
+        if ((UpdateMemoryStats(nullptr) + estimate) > m_MemoryBudget)
         {
-            memcpy(pPixels, src, copyStride);
-            pPixels += copyStride;
-            src += this->m_CanvasStride;
-        }
+            m_Textures->Sweep(m_Textures->GetCount());
+            auto total = UpdateMemoryStats(nullptr) + estimate;
 
-        CLSID pngClsid;
-        GetEncoderClsid(L"image/png", &pngClsid);
-        auto index = 0;
-        wchar_t nameBuffer[256];
-        swprintf_s(nameBuffer, L"%S\\rect_%u.png", m_SavePath, index);
-        while (std::filesystem::exists(nameBuffer))
-        {
-            index++;
-            swprintf_s(nameBuffer, L"%S\\rect_%u.png", m_SavePath, index);
+            // Over budget, shed cached bitmaps and staging slots first and then fall back to 16-bit for full color textures..
+            if (total > m_MemoryBudget)
+            {
+                auto cacheBytes = (uint64_t)m_RasterCache->GetBytes();
+                auto overflow   = total - m_MemoryBudget;
+                m_RasterCache->Trim((cacheBytes > overflow) ? (size_t)(cacheBytes - overflow) : 0);
+                overflow        = (overflow > cacheBytes) ? (overflow - cacheBytes) : 0;
+                auto ringBytes  = m_StagingRing->GetBytes();
+                m_StagingRing->Trim((ringBytes > overflow) ? (ringBytes - overflow) : 0);
+                if ((overflow > ringBytes) && ((requestFormat == D3DFMT_A8R8G8B8) || (requestFormat == D3DFMT_X8R8G8B8)))
+                {
+                    requestFormat = D3DFMT_A4R4G4B4;
+                    m_FallbackCount++;
+                }
+            }
         }
-        pRaw->Save(nameBuffer, &pngClsid, NULL);
-        delete pRaw;
-        DeleteObject(pBmp);
     }
 
-    // Create return object..
-    GdiFontReturn_t ret;
+    IDirect3DTexture8* pTexture = CreateTexture(source, sourcePitch, width, height, requestFormat, m_GenerateMipmaps ? 0 : 1, m_TexturePool);
+    if (!pTexture)
+        return GdiFontReturnEx_t();
+
+    // Default pool textures are lost with the device, keep a compact copy of the pixels to rebuild them from..
+    std::vector<uint8_t> backup;
+    if (m_TexturePool == D3DPOOL_DEFAULT)
+        EncodeRle(source, sourcePitch, width, height, &backup);
+    auto handle = m_Textures->Track(pTexture, m_TexturePool, width, height, std::move(backup));
+    UpdateMemoryStats(nullptr);
+
+    D3DSURFACE_DESC surfaceDesc;
+    pTexture->GetLevelDesc(0, &surfaceDesc);
+
+    GdiFontReturnEx_t ret;
     ret.Width   = width;
     ret.Height  = height;
     ret.Texture = pTexture;
+    ret.Format  = surfaceDesc.Format;
+    ret.Handle  = handle;
     return ret;
 }
 
-Gdiplus::Color GdiFontManager::UINT32_TO_COLOR(uint32_t color)
+IDirect3DTexture8* GdiFontManager::CreateTexture(const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height, D3DFORMAT format, uint32_t levels, D3DPOOL pool)
 {
-    auto alpha = (color & 0xFF000000) >> 24;
-    auto red   = (color & 0x00FF0000) >> 16;
-    auto green = (color & 0x0000FF00) >> 8;
-    auto blue  = (color & 0x000000FF);
-    return Gdiplus::Color(alpha, red, green, blue);
+    IDirect3DTexture8* pTexture;
+    if (FAILED(::D3DXCreateTexture(this->m_Device, width, height, levels, 0, format, pool, &pTexture)))
+        return nullptr;
+
+    if (pool != D3DPOOL_DEFAULT)
+    {
+        if (UploadTexture(pTexture, pTexture->GetLevelCount(), source, sourcePitch, width, height))
+            return pTexture;
+        pTexture->Release();
+        return nullptr;
+    }
+
+    // Default pool textures cannot be locked, pixels are written to a system memory texture and copied over..
+    D3DSURFACE_DESC surfaceDesc;
+    pTexture->GetLevelDesc(0, &surfaceDesc);
+    auto levelCount = pTexture->GetLevelCount();
+    auto uploaded   = false;
+    if ((surfaceDesc.Format == D3DFMT_DXT3) || (surfaceDesc.Format == D3DFMT_DXT5))
+    {
+        // Block compressed copies have to cover whole blocks, so these get a staging texture of matching size..
+        IDirect3DTexture8* pStaging;
+        if (SUCCEEDED(m_Device->CreateTexture(surfaceDesc.Width, surfaceDesc.Height, levelCount, 0, surfaceDesc.Format, D3DPOOL_SYSTEMMEM, &pStaging)))
+        {
+            uploaded = UploadTexture(pStaging, levelCount, source, sourcePitch, width, height) && SUCCEEDED(m_Device->UpdateTexture(pStaging, pTexture));
+            pStaging->Release();
+        }
+    }
+    else
+    {
+        auto pStaging = m_StagingRing->Acquire(surfaceDesc.Format, surfaceDesc.Width, surfaceDesc.Height, levelCount);
+        uploaded      = pStaging && UploadTexture(pStaging, levelCount, source, sourcePitch, width, height);
+
+        // Only the written part of each level is copied..
+        auto levelWidth  = width;
+        auto levelHeight = height;
+        for (DWORD level = 0; uploaded && (level < levelCount); level++)
+        {
+            IDirect3DSurface8* pSource;
+            IDirect3DSurface8* pDest;
+            if (FAILED(pStaging->GetSurfaceLevel(level, &pSource)))
+            {
+                uploaded = false;
+                break;
+            }
+            if (FAILED(pTexture->GetSurfaceLevel(level, &pDest)))
+            {
+                pSource->Release();
+                uploaded = false;
+                break;
+            }
+
+            RECT rect   = {0, 0, levelWidth, levelHeight};
+            POINT point = {0, 0};
+            uploaded    = SUCCEEDED(m_Device->CopyRects(pSource, &rect, 1, pDest, &point));
+            pSource->Release();
+            pDest->Release();
+            levelWidth  = (levelWidth > 1) ? (levelWidth / 2) : 1;
+            levelHeight = (levelHeight > 1) ? (levelHeight / 2) : 1;
+        }
+    }
+
+    if (uploaded)
+        return pTexture;
+    pTexture->Release();
+    return nullptr;
 }
 
-void GdiFontManager::ClearCanvas(int width, int height)
+bool GdiFontManager::UploadTexture(IDirect3DTexture8* pTexture, uint32_t levelCount, const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height)
 {
-    auto clearStride = width * 4;
-    auto pixels      = this->m_Pixels;
-    for (int x = 0; x < height; x++)
+    // D3DX substitutes the closest format the device supports, so convert to whatever was actually created..
+    D3DSURFACE_DESC surfaceDesc;
+    if (FAILED(pTexture->GetLevelDesc(0, &surfaceDesc)) || !UploadLevel(pTexture, 0, source, sourcePitch, width, height, surfaceDesc.Format))
+        return false;
+
+    // Build the rest of the mip chain on the cpu, each level filtered from the previous one..
+    MipChain chain(source, sourcePitch, width, height);
+    for (uint32_t level = 1; level < levelCount; level++)
     {
-        memset(pixels, 0, clearStride);
-        pixels += this->m_CanvasStride;
+        if (!chain.Next() || !UploadLevel(pTexture, level, chain.GetPixels(), chain.GetPitch(), chain.GetWidth(), chain.GetHeight(), surfaceDesc.Format))
+            return false;
     }
+    return true;
 }
 
-Gdiplus::Brush* GdiFontManager::GetBrush(GdiFontData_t data, int width, int height)
+bool GdiFontManager::UploadLevel(IDirect3DTexture8* pTexture, uint32_t level, const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height, D3DFORMAT format)
 {
-    if (data.GradientStyle == 0)
+    auto compressed = (format == D3DFMT_DXT3) || (format == D3DFMT_DXT5);
+    BlitFormat blitFormat;
+    if (!compressed && !GetBlitFormat(format, &blitFormat))
+        return false;
+
+    // Copy pixels row by row honoring the driver pitch, which may be padded beyond the row size..
+    D3DLOCKED_RECT rect{};
+    if (FAILED(pTexture->LockRect(level, &rect, nullptr, 0)))
+        return false;
+
+    if (compressed)
     {
-        auto color = UINT32_TO_COLOR(data.FontColor);
-        return new Gdiplus::SolidBrush(color);
+        auto dxtFormat = (format == D3DFMT_DXT3) ? DxtFormat::DXT3 : DxtFormat::DXT5;
+        EncodeDxt((uint8_t*)rect.pBits, rect.Pitch, source, sourcePitch, width, height, dxtFormat, m_Premultiply, std::thread::hardware_concurrency());
     }
-
-    Gdiplus::Point start(0, 0);
-    Gdiplus::Point end(0, 0);
-    switch (data.GradientStyle)
+    else
     {
-        //Left to right
-        case 1:
-            end.X = width;
-            break;
-
-        //Top-Left to Bottom Right
-        case 2:
-            end.X = width;
-            end.Y = height;
-            break;
+        uint32_t flags = BlitFlagNone;
+        if (m_Premultiply)
+            flags |= BlitFlagPremultiply;
+        if (m_Dither)
+            flags |= BlitFlagDither;
+        auto streaming = ((uint32_t)width * (uint32_t)height * GetBytesPerPixel(blitFormat)) >= StreamingThreshold;
+        BlitPixels((uint8_t*)rect.pBits, rect.Pitch, source, sourcePitch, width, height, blitFormat, flags, streaming);
+    }
+    pTexture->UnlockRect(level);
+    return true;
+}
 
-        //Top to bottom
-        case 3:
-            end.Y = height;
-            break;
+void GdiFontManager::SaveTextureDump(const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height, const wchar_t* prefix)
+{
+    BITMAPV4HEADER bmp   = {sizeof(BITMAPV4HEADER)};
+    bmp.bV4Width         = width;
+    bmp.bV4Height        = height;
+    bmp.bV4Planes        = 1;
+    bmp.bV4BitCount      = 32;
+    bmp.bV4V4Compression = BI_BITFIELDS;
+    bmp.bV4RedMask       = 0x00FF0000;
+    bmp.bV4GreenMask     = 0x0000FF00;
+    bmp.bV4BlueMask      = 0x000000FF;
+    bmp.bV4AlphaMask     = 0xFF000000;
+
+    uint8_t* pPixels      = nullptr;
+    HBITMAP pBmp          = ::CreateDIBSection(nullptr, (BITMAPINFO*)&bmp, DIB_RGB_COLORS, (void**)&pPixels, nullptr, 0);
+    Gdiplus::Bitmap* pRaw = new Gdiplus::Bitmap(width, height, width * 4, PixelFormat32bppARGB, (BYTE*)pPixels);
+
+    BlitPixels(pPixels, width * 4, source, sourcePitch, width, height, BlitFormat::A8R8G8B8, BlitFlagNone, false);
+
+    CLSID pngClsid;
+    GetEncoderClsid(L"image/png", &pngClsid);
+    auto index = 0;
+    wchar_t nameBuffer[256];
+    swprintf_s(nameBuffer, L"%S\\%s_%u.png", m_SavePath, prefix, index);
+    while (std::filesystem::exists(nameBuffer))
+    {
+        index++;
+        swprintf_s(nameBuffer, L"%S\\%s_%u.png", m_SavePath, prefix, index);
+    }
+    pRaw->Save(nameBuffer, &pngClsid, NULL);
+    delete pRaw;
+    DeleteObject(pBmp);
+}
 
-        //Top-Right to Bottom Left
-        case 4:
-            start.X = width;
-            end.Y   = height;
-            break;
+Gdiplus::Color GdiFontManager::UINT32_TO_COLOR(uint32_t color)
+{
+    auto alpha = (color & 0xFF000000) >> 24;
+    auto red   = (color & 0x00FF0000) >> 16;
+    auto green = (color & 0x0000FF00) >> 8;
+    auto blue  = (color & 0x000000FF);
+    return Gdiplus::Color(alpha, red, green, blue);
+}
 
-        //Right to Left
-        case 5:
-            start.X = width;
-            break;
+void GdiFontManager::EnableTextureDump(const char* folder)
+{
+    strcpy_s(m_SavePath, 1024, folder);
+    m_SaveToHardDrive = true;
+}
+void GdiFontManager::DisableTextureDump()
+{
+    m_SaveToHardDrive = false;
+}
+void GdiFontManager::EnablePremultipliedAlpha()
+{
+    m_Premultiply = true;
+}
+void GdiFontManager::DisablePremultipliedAlpha()
+{
+    m_Premultiply = false;
+}
+bool GdiFontManager::SetTextureFormat(D3DFORMAT format, bool dither)
+{
+    if ((format != D3DFMT_A8R8G8B8) && (format != D3DFMT_A4R4G4B4) && (format != D3DFMT_A1R5G5B5))
+        return false;
 
-        //Bottom-Right to Top Left
-        case 6:
-            start.X = width;
-            start.Y = height;
-            break;
+    m_TextureFormat = format;
+    m_Dither        = dither;
+    return true;
+}
+bool GdiFontManager::SetTextureCompression(D3DFORMAT format, uint32_t minimumPixels)
+{
+    if ((format != D3DFMT_UNKNOWN) && (format != D3DFMT_DXT3) && (format != D3DFMT_DXT5))
+        return false;
 
-        //Bottom to Top
-        case 7:
-            start.Y = height;
-            break;
+    m_CompressionFormat    = format;
+    m_CompressionThreshold = minimumPixels;
+    return true;
+}
+void GdiFontManager::EnableMipmaps()
+{
+    m_GenerateMipmaps = true;
+}
+void GdiFontManager::DisableMipmaps()
+{
+    m_GenerateMipmaps = false;
+}
+void GdiFontManager::EnableDilatedOutline()
+{
+    m_DilatedOutline = true;
+}
+void GdiFontManager::DisableDilatedOutline()
+{
+    m_DilatedOutline = false;
+}
+bool GdiFontManager::EnableDiskCache(const char* path, uint32_t maxMegabytes)
+{
+    DisableDiskCache();
+    m_DiskCache = new PackFile();
+    if (!m_DiskCache->Open(path, (uint64_t)maxMegabytes * 1024 * 1024))
+    {
+        DisableDiskCache();
+        return false;
+    }
+    return true;
+}
+void GdiFontManager::DisableDiskCache()
+{
+    // Prewarm workers write through to the file, stop them before it is swapped or goes away..
+    CancelPrewarm();
+    delete m_DiskCache;
+    m_DiskCache = nullptr;
+}
+bool GdiFontManager::PrewarmFromManifest(const char* path)
+{
+    CancelPrewarm();
 
-        //Bottom-Left to Top Right
-        case 8:
-            start.Y = height;
-            end.X   = width;
-            break;
+    std::ifstream manifest(std::filesystem::path((const char8_t*)path), std::ios::binary);
+    if (!manifest)
+        return false;
 
-        default:
-            end.X = width;
-            break;
+    // One entry per line: family, height, flags, color, outline color, outline width, gradient style, gradient color,
+    // box width, box height and text, separated by tabs. Colors are hex, lines starting with # are comments..
+    std::string line;
+    while (std::getline(manifest, line))
+    {
+        if (!line.empty() && (line.back() == '\r'))
+            line.pop_back();
+        if (line.empty() || (line[0] == '#'))
+            continue;
+
+        std::vector<std::string> fields;
+        size_t start = 0;
+        while (fields.size() < 10)
+        {
+            auto end = line.find('\t', start);
+            if (end == std::string::npos)
+                break;
+            fields.push_back(line.substr(start, end - start));
+            start = end + 1;
+        }
+        if (fields.size() != 10)
+            continue;
+        fields.push_back(line.substr(start));
+
+        auto familyId = RegisterFontFamily(fields[0].c_str());
+        if (familyId == 0)
+            continue;
+
+        PrewarmEntry_t entry{};
+        entry.Desc.FontFamilyId  = familyId;
+        entry.Desc.FontHeight    = strtof(fields[1].c_str(), nullptr);
+        entry.Desc.FontFlags     = strtol(fields[2].c_str(), nullptr, 10);
+        entry.Desc.FontColor     = strtoul(fields[3].c_str(), nullptr, 16);
+        entry.Desc.OutlineColor  = strtoul(fields[4].c_str(), nullptr, 16);
+        entry.Desc.OutlineWidth  = strtof(fields[5].c_str(), nullptr);
+        entry.Desc.GradientStyle = strtoul(fields[6].c_str(), nullptr, 10);
+        entry.Desc.GradientColor = strtoul(fields[7].c_str(), nullptr, 16);
+        entry.Desc.BoxWidth      = strtol(fields[8].c_str(), nullptr, 10);
+        entry.Desc.BoxHeight     = strtol(fields[9].c_str(), nullptr, 10);
+        entry.BoxWidth           = (entry.Desc.BoxWidth == 0) ? m_CanvasWidth : entry.Desc.BoxWidth;
+        entry.BoxHeight          = (entry.Desc.BoxHeight == 0) ? m_CanvasHeight : entry.Desc.BoxHeight;
+        entry.Text               = UnescapeManifestText(fields[10]);
+        const std::wstring* names[GdiMaxFontFallbacks + 1];
+        auto count = GetFontChainNames(familyId, names);
+        for (uint32_t i = 0; i < count; i++)
+            entry.FontFamilies.push_back(*names[i]);
+        if (!entry.Text.empty())
+            m_PrewarmEntries.push_back(std::move(entry));
     }
 
-    return new Gdiplus::LinearGradientBrush(start, end, UINT32_TO_COLOR(data.FontColor), UINT32_TO_COLOR(data.GradientColor));
+    // Point descriptors at their text now that the entries no longer move, and skip anything already cached..
+    std::vector<PrewarmEntry_t> pending;
+    for (auto& entry : m_PrewarmEntries)
+    {
+        entry.Desc.FontText       = entry.Text.c_str();
+        entry.Desc.FontTextLength = (uint32_t)entry.Text.size();
+        entry.Key                 = HashFontRequest(entry.Desc, entry.BoxWidth, entry.BoxHeight);
+
+        int32_t width, height;
+        const uint8_t* pixels;
+        if (m_RasterCache->Contains(entry.Key) || (m_DiskCache && m_DiskCache->Find(entry.Key, &width, &height, &pixels)))
+            continue;
+        pending.push_back(std::move(entry));
+    }
+    m_PrewarmEntries = std::move(pending);
+    for (auto& entry : m_PrewarmEntries)
+        entry.Desc.FontText = entry.Text.c_str();
+
+    // Each worker owns a full canvas, so keep the count small..
+    auto workers = std::thread::hardware_concurrency() / 2;
+    if (workers > 2)
+        workers = 2;
+    if (workers < 1)
+        workers = 1;
+    for (uint32_t i = 0; (i < workers) && (i < m_PrewarmEntries.size()); i++)
+        m_PrewarmThreads.emplace_back(&GdiFontManager::PrewarmWorker, this);
+    return true;
 }
 
-Gdiplus::Brush* GdiFontManager::GetBrush(GdiRectData_t data, int width, int height)
+void GdiFontManager::PrewarmWorker()
 {
-    if (data.GradientStyle == 0)
+    // Each worker gets its own font families from the runtime and leases a canvas per entry..
+    std::vector<wchar_t> text;
+
+    uint32_t index;
+    while (!m_PrewarmCancel && ((index = m_PrewarmNext++) < m_PrewarmEntries.size()))
     {
-        auto color = UINT32_TO_COLOR(data.FillColor);
-        return new Gdiplus::SolidBrush(color);
+        auto& entry = m_PrewarmEntries[index];
+        const std::wstring* names[GdiMaxFontFallbacks + 1];
+        for (size_t i = 0; i < entry.FontFamilies.size(); i++)
+            names[i] = &entry.FontFamilies[i];
+        FontChain_t chain;
+        auto valid = GetFontChain(names, (uint32_t)entry.FontFamilies.size(), &chain);
+
+        if (text.size() < entry.Text.size())
+            text.resize(entry.Text.size());
+        auto length = (INT)Utf8ToUtf16(entry.Text.c_str(), (uint32_t)entry.Text.size(), (uint16_t*)text.data());
+
+        GdiTextDesc_t desc{};
+        desc.Font = entry.Desc;
+        CanvasLease canvas;
+        CanvasRegion_t region;
+        if (valid && RenderFont(canvas.Get(), chain, desc, text.data(), length, entry.BoxWidth, entry.BoxHeight, false, &region))
+            StoreRaster(entry.Key, region);
+
+        m_PrewarmCompleted++;
     }
 
-    Gdiplus::Point start(0, 0);
-    Gdiplus::Point end(0, 0);
+    GdiRuntime::Get()->ReleaseThread();
+}
 
-    switch (data.GradientStyle)
-    {
-        //Left to right
-        case 1:
-            end.X = width;
-            break;
+// Shared by CreateText and the prewarm workers, both caches lock themselves..
+void GdiFontManager::StoreRaster(uint64_t key, const CanvasRegion_t& region)
+{
+    m_RasterCache->Insert(key, region.Width, region.Height, region.Pixels, region.Pitch);
+    if (m_DiskCache)
+        m_DiskCache->Insert(key, region.Width, region.Height, region.Pixels, region.Pitch);
+}
 
-        //Top-Left to Bottom Right
-        case 2:
-            end.X = width;
-            end.Y = height;
-            break;
+bool GdiFontManager::GetPrewarmProgress(uint32_t* pCompleted, uint32_t* pTotal)
+{
+    auto total  = (uint32_t)m_PrewarmEntries.size();
+    auto done   = m_PrewarmCompleted.load();
+    *pCompleted = (done < total) ? done : total;
+    *pTotal     = total;
+    return !m_PrewarmCancel && (done < total);
+}
 
-        //Top to bottom
-        case 3:
-            end.Y = height;
-            break;
+void GdiFontManager::CancelPrewarm()
+{
+    m_PrewarmCancel = true;
+    for (auto& thread : m_PrewarmThreads)
+        thread.join();
+    m_PrewarmThreads.clear();
+    m_PrewarmEntries.clear();
+    m_PrewarmNext      = 0;
+    m_PrewarmCompleted = 0;
+    m_PrewarmCancel    = false;
+}
 
-        //Top-Right to Bottom Left
-        case 4:
-            start.X = width;
-            end.Y   = height;
-            break;
+void GdiFontManager::SetMemoryBudget(uint64_t bytes)
+{
+    m_MemoryBudget = bytes;
+}
 
-        //Right to Left
-        case 5:
-            start.X = width;
-            break;
+void GdiFontManager::GetMemoryStats(GdiMemoryStats_t* pStats)
+{
+    m_Textures->Sweep(m_Textures->GetCount());
+    UpdateMemoryStats(pStats);
+}
 
-        //Bottom-Right to Top Left
-        case 6:
-            start.X = width;
-            start.Y = height;
-            break;
+uint64_t GdiFontManager::UpdateMemoryStats(GdiMemoryStats_t* pStats)
+{
+    // Canvases are shared by every manager in the process..
+    auto canvasBytes  = CanvasPool::Get()->GetBytes();
+    auto cacheBytes   = (uint64_t)m_RasterCache->GetBytes();
+    auto textureBytes = m_Textures->GetVideoBytes();
+    auto shadowBytes  = m_Textures->GetShadowBytes();
+    auto stagingBytes = m_StagingRing->GetBytes();
+    auto total        = textureBytes + shadowBytes + canvasBytes + cacheBytes + stagingBytes;
+    auto count        = m_Textures->GetCount();
+
+    m_PeakTextureBytes = (textureBytes > m_PeakTextureBytes) ? textureBytes : m_PeakTextureBytes;
+    m_PeakTotalBytes   = (total > m_PeakTotalBytes) ? total : m_PeakTotalBytes;
+    m_PeakTextureCount = (count > m_PeakTextureCount) ? count : m_PeakTextureCount;
+
+    if (pStats)
+    {
+        pStats->TextureBytes     = textureBytes;
+        pStats->ShadowBytes      = shadowBytes;
+        pStats->CanvasBytes      = canvasBytes;
+        pStats->CacheBytes       = cacheBytes;
+        pStats->TotalBytes       = total;
+        pStats->PeakTextureBytes = m_PeakTextureBytes;
+        pStats->PeakTotalBytes   = m_PeakTotalBytes;
+        pStats->Budget           = m_MemoryBudget;
+        pStats->TextureCount     = count;
+        pStats->PeakTextureCount = m_PeakTextureCount;
+        pStats->FallbackCount    = m_FallbackCount;
+        pStats->StagingBytes     = stagingBytes;
+        CanvasPool::Get()->GetLeaseStats(&pStats->CanvasCount, &pStats->CanvasLeases, &pStats->PeakCanvasLeases);
+    }
+    return total;
+}
 
-        //Bottom to Top
-        case 7:
-            start.Y = height;
-            break;
+void GdiFontManager::SetCanvasPoolLimit(uint32_t count)
+{
+    CanvasPool::Get()->SetLimit(count);
+}
 
-        //Bottom-Left to Top Right
-        case 8:
-            start.Y = height;
-            end.X   = width;
-            break;
+void GdiFontManager::EnableDefaultPool()
+{
+    m_TexturePool = D3DPOOL_DEFAULT;
+}
+void GdiFontManager::DisableDefaultPool()
+{
+    m_TexturePool = D3DPOOL_MANAGED;
+}
 
-        default:
-            end.X = width;
-            break;
-    }
+void GdiFontManager::OnDeviceLost()
+{
+    // Forget textures the caller already dropped, the rest are rebuilt on reset..
+    ReleaseNineSlices();
+    m_Textures->Sweep(m_Textures->GetCount());
+    m_Textures->ReleaseDefaultPool();
+    for (auto pBlock : m_TextBlocks)
+        pBlock->OnDeviceLost();
+}
 
-    return new Gdiplus::LinearGradientBrush(start, end, UINT32_TO_COLOR(data.FillColor), UINT32_TO_COLOR(data.GradientColor));
+void GdiFontManager::OnDeviceReset()
+{
+    std::vector<uint8_t> pixels;
+    m_Textures->Restore([&](const uint8_t* backup, int32_t width, int32_t height, D3DFORMAT format, uint32_t levels) {
+        pixels.resize((size_t)width * height * 4);
+        DecodeRle(pixels.data(), width * 4, width, height, backup);
+        return CreateTexture(pixels.data(), width * 4, width, height, format, levels, D3DPOOL_DEFAULT);
+    });
+    for (auto pBlock : m_TextBlocks)
+        pBlock->OnDeviceReset();
+    UpdateMemoryStats(nullptr);
 }
 
-void GdiFontManager::EnableTextureDump(const char* folder)
+IDirect3DTexture8* GdiFontManager::GetRestoredTexture(uint32_t handle)
 {
-    strcpy_s(m_SavePath, 1024, folder);
-    m_SaveToHardDrive = true;
+    return m_Textures->Claim(handle);
 }
-void GdiFontManager::DisableTextureDump()
+
+const uint32_t* GdiFontManager::GetGradientRamp(const GdiGradient_t& gradient)
 {
-    m_SaveToHardDrive = false;
+    auto key  = HashGradient(gradient, HashSeed);
+    auto iter = m_GradientRamps.find(key);
+    if (iter != m_GradientRamps.end())
+        return iter->second.data();
+
+    // Designers use a handful of gradients, if this grows something is generating them so start over..
+    if (m_GradientRamps.size() >= 256)
+        m_GradientRamps.clear();
+
+    GradientStop_t stops[GdiMaxGradientStops];
+    auto stopCount = (gradient.StopCount < GdiMaxGradientStops) ? gradient.StopCount : GdiMaxGradientStops;
+    for (uint32_t i = 0; i < stopCount; i++)
+    {
+        stops[i].Position = gradient.Stops[i].Position;
+        stops[i].Color    = gradient.Stops[i].Color;
+    }
+
+    auto& ramp = m_GradientRamps[key];
+    ramp.resize(GradientLutSize);
+    BuildGradientRamp(stops, stopCount, ramp.data());
+    return ramp.data();
 }
\ No newline at end of file
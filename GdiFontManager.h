@@ -6,38 +6,146 @@
 #endif
 
 #include "Defines.h"
+#include "FontIndex.h"
+#include "GdiCanvas.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class PackFile;
+class RasterCache;
+class StagingRing;
+class TextBlock;
+class TextPanel;
+class TextureTracker;
+
+// Font families for one render, the primary first and then its fallbacks. Coverage is only filled in when
+// there are fallbacks to choose between.
+struct FontChain_t
+{
+    Gdiplus::FontFamily* Families[GdiMaxFontFallbacks + 1];
+    std::shared_ptr<const FontCoverage_t> Coverage[GdiMaxFontFallbacks + 1];
+    uint32_t Count;
+};
 
 class GdiFontManager
 {
 private:
-    ULONG_PTR m_GDIToken;
     IDirect3DDevice8* m_Device;
-    Gdiplus::Bitmap* m_Bitmap;
-    Gdiplus::Graphics* m_Graphics;
-
-    // Bitmap components
     int m_CanvasWidth;
     int m_CanvasHeight;
-    int m_CanvasStride;
-    int m_Size;
-    void* m_RawImage;
-    uint8_t* m_Pixels;
     bool m_SaveToHardDrive;
     char m_SavePath[1024];
+    bool m_Premultiply;
+    D3DFORMAT m_TextureFormat;
+    bool m_Dither;
+    D3DFORMAT m_CompressionFormat;
+    uint32_t m_CompressionThreshold;
+    bool m_GenerateMipmaps;
+    D3DPOOL m_TexturePool;
+    StagingRing* m_StagingRing;
+    bool m_DilatedOutline;
+
+    // Interned font families, id is index + 1. Gdiplus objects for them live in the runtime..
+    std::map<std::string, uint32_t> m_FontFamilyIds;
+    std::vector<std::wstring> m_FontFamilyNames;
+    std::vector<uint64_t> m_FontIdentities;
+    std::map<uint32_t, std::vector<uint32_t>> m_FontFallbacks; // Family id to the ids tried after it.
+    std::map<uint64_t, GdiFontReturnEx_t> m_NineSlices; // Holds a reference to each texture.
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_GradientRamps;
+    std::vector<wchar_t> m_TextBuffer;
+    std::vector<TextBlock*> m_TextBlocks;
+    std::vector<TextPanel*> m_TextPanels;
+    PackFile* m_DiskCache;
+    RasterCache* m_RasterCache; // Shared through the runtime.
 
+    // Memory accounting, budget of zero is unlimited..
+    TextureTracker* m_Textures;
+    uint64_t m_MemoryBudget;
+    uint64_t m_PeakTextureBytes;
+    uint64_t m_PeakTotalBytes;
+    uint32_t m_PeakTextureCount;
+    uint32_t m_FallbackCount;
+
+    // Background prewarming, entries are read only while workers run..
+    struct PrewarmEntry_t
+    {
+        GdiFontDesc_t Desc;
+        std::string Text;
+        std::vector<std::wstring> FontFamilies; // Primary first, then its fallbacks.
+        int32_t BoxWidth;
+        int32_t BoxHeight;
+        uint64_t Key;
+    };
+    std::vector<PrewarmEntry_t> m_PrewarmEntries;
+    std::vector<std::thread> m_PrewarmThreads;
+    std::atomic<uint32_t> m_PrewarmNext;
+    std::atomic<uint32_t> m_PrewarmCompleted;
+    std::atomic<bool> m_PrewarmCancel;
 
 public:
     GdiFontManager(IDirect3DDevice8* pDevice);
     ~GdiFontManager();
-    GdiFontReturn_t CreateFontTexture(GdiFontData_t data);
-    GdiFontReturn_t CreateRectTexture(GdiRectData_t data);
+    uint32_t RegisterFontFamily(const char* family);
+    bool SetFontFallbacks(uint32_t familyId, const uint32_t* pFallbackIds, uint32_t count);
+    GdiFontReturnEx_t CreateFontTexture(const GdiFontData_t& data);
+    GdiFontReturnEx_t CreateFontTexture(const GdiFontDesc_t& data, const GdiGradient_t* pGradient);
+    GdiFontReturnEx_t CreateTextTexture(const GdiTextDesc_t& desc);
+    GdiFontReturnEx_t CreateMarkupTexture(const GdiTextDesc_t& desc);
+    TextBlock* CreateTextBlock(const GdiTextDesc_t& style, uint32_t capacity, bool markup);
+    void DestroyTextBlock(TextBlock* pBlock);
+    float GetLineSpacing(uint32_t familyId, int32_t flags, float height);
+    TextPanel* CreateTextPanel(const GdiFontDesc_t& style, uint32_t lineCount);
+    void DestroyTextPanel(TextPanel* pPanel);
+    bool DrawPanelLine(IDirect3DTexture8* pTexture, const GdiFontDesc_t& style, const char* text, uint32_t length, int32_t top, int32_t width, int32_t pitch, int32_t* pWidth, int32_t* pHeight);
+    uint64_t HashPanelSettings(uint64_t seed) const;
+    GdiFontReturnEx_t CreateRectTexture(const GdiRectData_t& data, const GdiGradient_t* pGradient);
+    GdiFontReturnEx_t CreateNineSliceRectTexture(const GdiRectData_t& data, GdiNineSlice_t* pSlice);
     void EnableTextureDump(const char* Folder);
     void DisableTextureDump();
-    
+    void EnablePremultipliedAlpha();
+    void DisablePremultipliedAlpha();
+    bool SetTextureFormat(D3DFORMAT format, bool dither);
+    bool SetTextureCompression(D3DFORMAT format, uint32_t minimumPixels);
+    void EnableMipmaps();
+    void DisableMipmaps();
+    void EnableDilatedOutline();
+    void DisableDilatedOutline();
+    bool EnableDiskCache(const char* path, uint32_t maxMegabytes);
+    void DisableDiskCache();
+    bool PrewarmFromManifest(const char* path);
+    bool GetPrewarmProgress(uint32_t* pCompleted, uint32_t* pTotal);
+    void CancelPrewarm();
+    void SetMemoryBudget(uint64_t bytes);
+    void GetMemoryStats(GdiMemoryStats_t* pStats);
+    void SetCanvasPoolLimit(uint32_t count);
+    void EnableDefaultPool();
+    void DisableDefaultPool();
+    void OnDeviceLost();
+    void OnDeviceReset();
+    IDirect3DTexture8* GetRestoredTexture(uint32_t handle);
+
 private:
+    static bool GetFontChain(const std::wstring* const* ppNames, uint32_t count, FontChain_t* pChain);
+    uint32_t GetFontChainNames(uint32_t familyId, const std::wstring** ppNames);
+    GdiFontReturnEx_t CreateText(const GdiTextDesc_t& desc, bool markup);
+    uint64_t HashFontRequest(const GdiFontDesc_t& data, int32_t boxWidth, int32_t boxHeight);
+    bool RenderFont(GdiCanvas* pCanvas, const FontChain_t& chain, const GdiTextDesc_t& desc, const wchar_t* text, INT length, int32_t boxWidth, int32_t boxHeight, bool markup, CanvasRegion_t* pRegion);
+    void PrewarmWorker();
+    void StoreRaster(uint64_t key, const CanvasRegion_t& region);
+    uint64_t UpdateMemoryStats(GdiMemoryStats_t* pStats);
+    const uint32_t* GetGradientRamp(const GdiGradient_t& gradient);
+    uint64_t HashTextureSettings(uint64_t seed) const;
+    void ReleaseNineSlices();
+    GdiFontReturnEx_t CreateTextureFromCanvas(const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height);
+    IDirect3DTexture8* CreateTexture(const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height, D3DFORMAT format, uint32_t levels, D3DPOOL pool);
+    bool UploadTexture(IDirect3DTexture8* pTexture, uint32_t levelCount, const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height);
+    bool UploadLevel(IDirect3DTexture8* pTexture, uint32_t level, const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height, D3DFORMAT format);
+    void SaveTextureDump(const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height, const wchar_t* prefix);
     Gdiplus::Color UINT32_TO_COLOR(uint32_t color);
-    void ClearCanvas(int width, int height);
-    Gdiplus::Brush* GetBrush(GdiFontData_t data, int width, int height);
-    Gdiplus::Brush* GetBrush(GdiRectData_t data, int width, int height);
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "GdiRuntime.h"
+#include "CanvasPool.h"
+#include "RasterCache.h"
+
+GdiRuntime::GdiRuntime()
+    : m_Users(0)
+    , m_Token(0)
+    , m_RasterCache(nullptr)
+{}
+
+GdiRuntime* GdiRuntime::Get()
+{
+    static GdiRuntime runtime;
+    return &runtime;
+}
+
+void GdiRuntime::Attach()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_Users++ == 0)
+        {
+            Gdiplus::GdiplusStartupInput gdiplusStartupInput;
+            Gdiplus::GdiplusStartup(&m_Token, &gdiplusStartupInput, NULL);
+            m_RasterCache = new RasterCache(16 * 1024 * 1024);
+        }
+    }
+    CanvasPool::Get()->Attach();
+}
+
+void GdiRuntime::Detach()
+{
+    // Canvases hold gdiplus bitmaps, so the pool lets go of them first..
+    CanvasPool::Get()->Detach();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (--m_Users != 0)
+        return;
+
+    for (auto& thread : m_Threads)
+        FreeThreadResources(thread.second);
+    m_Threads.clear();
+    delete m_RasterCache;
+    m_RasterCache = nullptr;
+    Gdiplus::GdiplusShutdown(m_Token);
+}
+
+GdiRuntime::ThreadResources_t* GdiRuntime::GetThreadResources()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto& pResources = m_Threads[std::this_thread::get_id()];
+    if (!pResources)
+    {
+        pResources               = new ThreadResources_t();
+        pResources->StringFormat = new Gdiplus::StringFormat();
+        pResources->StringFormat->SetAlignment(Gdiplus::StringAlignment::StringAlignmentNear);
+
+        // Runs laid out one after another need no padding and have to measure trailing spaces..
+        pResources->RunFormat = Gdiplus::StringFormat::GenericTypographic()->Clone();
+        pResources->RunFormat->SetFormatFlags(pResources->RunFormat->GetFormatFlags() | Gdiplus::StringFormatFlagsMeasureTrailingSpaces);
+    }
+    return pResources;
+}
+
+void GdiRuntime::FreeThreadResources(ThreadResources_t* pResources)
+{
+    for (auto& family : pResources->FontFamilies)
+        delete family.second;
+    delete pResources->StringFormat;
+    delete pResources->RunFormat;
+    delete pResources;
+}
+
+// Returns the calling thread's copy of a font family, or nullptr if gdiplus can't find it..
+Gdiplus::FontFamily* GdiRuntime::GetFontFamily(const std::wstring& name)
+{
+    // Only this thread touches its own resources, so the lookup itself needs no lock..
+    auto pResources = GetThreadResources();
+    auto iter       = pResources->FontFamilies.find(name);
+    if (iter != pResources->FontFamilies.end())
+        return iter->second;
+
+    auto pFontFamily = new Gdiplus::FontFamily(name.c_str());
+    if (pFontFamily->GetLastStatus() != Gdiplus::Ok)
+    {
+        delete pFontFamily;
+        return nullptr;
+    }
+    pResources->FontFamilies[name] = pFontFamily;
+    return pFontFamily;
+}
+
+const Gdiplus::StringFormat* GdiRuntime::GetStringFormat()
+{
+    return GetThreadResources()->StringFormat;
+}
+
+const Gdiplus::StringFormat* GdiRuntime::GetRunFormat()
+{
+    return GetThreadResources()->RunFormat;
+}
+
+// Frees the calling thread's font families and string format, for threads that are about to exit..
+void GdiRuntime::ReleaseThread()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto iter = m_Threads.find(std::this_thread::get_id());
+    if (iter == m_Threads.end())
+        return;
+    FreeThreadResources(iter->second);
+    m_Threads.erase(iter);
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef __GdiRuntime_H_INCLUDED__
+#define __GdiRuntime_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "Defines.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class RasterCache;
+
+// Gdiplus session and font resources shared by every manager in the process. The first manager to attach
+// starts gdiplus and the last one to detach shuts it down. Gdiplus objects report ObjectBusy when two threads
+// use them at once, so font families and string formats are kept per calling thread, while rendered bitmaps
+// are cached once for everyone.
+class GdiRuntime
+{
+private:
+    struct ThreadResources_t
+    {
+        std::map<std::wstring, Gdiplus::FontFamily*> FontFamilies;
+        Gdiplus::StringFormat* StringFormat;
+        Gdiplus::StringFormat* RunFormat;
+    };
+
+    std::mutex m_Mutex;
+    uint32_t m_Users;
+    ULONG_PTR m_Token;
+    std::map<std::thread::id, ThreadResources_t*> m_Threads;
+    RasterCache* m_RasterCache;
+
+    GdiRuntime();
+    ThreadResources_t* GetThreadResources();
+    static void FreeThreadResources(ThreadResources_t* pResources);
+
+public:
+    static GdiRuntime* Get();
+    void Attach();
+    void Detach();
+    Gdiplus::FontFamily* GetFontFamily(const std::wstring& name);
+    const Gdiplus::StringFormat* GetStringFormat();
+    const Gdiplus::StringFormat* GetRunFormat();
+    void ReleaseThread();
+    RasterCache* GetRasterCache() const { return m_RasterCache; }
+};
+#endif
\ No newline at end of file
@@ -0,0 +1,319 @@
+#include "Gradient.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define GRADIENT_SSE2
+#endif
+
+void GetGradientLine(uint32_t style, int32_t width, int32_t height, GradientShape_t* pShape)
+{
+    auto w  = (float)width;
+    auto h  = (float)height;
+    *pShape = GradientShape_t{};
+    switch (style)
+    {
+        //Left to right
+        case 1:
+            pShape->EndX = w;
+            break;
+
+        //Top-Left to Bottom Right
+        case 2:
+            pShape->EndX = w;
+            pShape->EndY = h;
+            break;
+
+        //Top to bottom
+        case 3:
+            pShape->EndY = h;
+            break;
+
+        //Top-Right to Bottom Left
+        case 4:
+            pShape->StartX = w;
+            pShape->EndY   = h;
+            break;
+
+        //Right to Left
+        case 5:
+            pShape->StartX = w;
+            break;
+
+        //Bottom-Right to Top Left
+        case 6:
+            pShape->StartX = w;
+            pShape->StartY = h;
+            break;
+
+        //Bottom to Top
+        case 7:
+            pShape->StartY = h;
+            break;
+
+        //Bottom-Left to Top Right
+        case 8:
+            pShape->StartY = h;
+            pShape->EndX   = w;
+            break;
+
+        default:
+            pShape->EndX = w;
+            break;
+    }
+}
+
+void BuildGradientRamp(const GradientStop_t* stops, uint32_t stopCount, uint32_t* pLut)
+{
+    if (stopCount == 0)
+    {
+        memset(pLut, 0, GradientLutSize * sizeof(uint32_t));
+        return;
+    }
+
+    uint32_t segment = 0;
+    for (int32_t i = 0; i < GradientLutSize; i++)
+    {
+        auto t = (float)i / (float)(GradientLutSize - 1);
+        while (((segment + 1) < stopCount) && (stops[segment + 1].Position <= t))
+            segment++;
+
+        // Before the first stop, after the last one, or on a stop exactly..
+        auto& from = stops[segment];
+        if ((t <= from.Position) || ((segment + 1) >= stopCount))
+        {
+            pLut[i] = from.Color;
+            continue;
+        }
+
+        auto& to    = stops[segment + 1];
+        auto weight = (t - from.Position) / (to.Position - from.Position);
+        uint32_t color = 0;
+        for (auto shift = 0; shift < 32; shift += 8)
+        {
+            auto a = (float)((from.Color >> shift) & 0xFF);
+            auto b = (float)((to.Color >> shift) & 0xFF);
+            color |= (uint32_t)(a + (b - a) * weight + 0.5f) << shift;
+        }
+        pLut[i] = color;
+    }
+}
+
+void BuildGradientLut(uint32_t startColor, uint32_t endColor, uint32_t* pLut)
+{
+    GradientStop_t stops[2] = {{0.0f, startColor}, {1.0f, endColor}};
+    BuildGradientRamp(stops, 2, pLut);
+}
+
+// Everything about a shape that does not change per pixel..
+struct ShapeSetup_t
+{
+    float StepX; // Linear index is x * StepX + y * StepY + Offset.
+    float StepY;
+    float Offset;
+    float Scale; // Radial index is distance * Scale, angular is turns * Scale.
+    float DirectionX;
+    float DirectionY;
+};
+
+static void SetupShape(const GradientShape_t& shape, ShapeSetup_t* pSetup)
+{
+    auto dx     = shape.EndX - shape.StartX;
+    auto dy     = shape.EndY - shape.StartY;
+    auto length = sqrtf(dx * dx + dy * dy);
+    auto top    = (float)(GradientLutSize - 1);
+
+    // Half added up front so truncation rounds..
+    auto scale         = (length > 0.0f) ? (top / (length * length)) : 0.0f;
+    pSetup->StepX      = dx * scale;
+    pSetup->StepY      = dy * scale;
+    pSetup->Offset     = 0.5f - (shape.StartX * pSetup->StepX + shape.StartY * pSetup->StepY);
+    pSetup->Scale      = (shape.Kind == GradientKind::Angular) ? top : ((length > 0.0f) ? (top / length) : 0.0f);
+    pSetup->DirectionX = (length > 0.0f) ? (dx / length) : 1.0f;
+    pSetup->DirectionY = (length > 0.0f) ? (dy / length) : 0.0f;
+}
+
+// Polynomial atan2 good to about 1e-5 radians, the same operations as the sse version so both agree..
+static inline float Atan2Approx(float y, float x)
+{
+    auto ax = fabsf(x);
+    auto ay = fabsf(y);
+    auto mn = (ax < ay) ? ax : ay;
+    auto mx = (ax < ay) ? ay : ax;
+    auto z  = mn / ((mx > 1e-20f) ? mx : 1e-20f);
+    auto z2 = z * z;
+    auto a  = z * (0.99997726f + z2 * (-0.33262347f + z2 * (0.19354346f + z2 * (-0.11643287f + z2 * (0.05265332f + z2 * -0.01172120f)))));
+    a       = (ay > ax) ? (1.57079637f - a) : a;
+    a       = (x < 0.0f) ? (3.14159274f - a) : a;
+    return (y < 0.0f) ? -a : a;
+}
+
+static inline int32_t ShadeIndex(const GradientShape_t& shape, const ShapeSetup_t& setup, float x, float y)
+{
+    auto top = (float)(GradientLutSize - 1);
+    float position;
+    if (shape.Kind == GradientKind::Radial)
+    {
+        auto dx  = x - shape.StartX;
+        auto dy  = y - shape.StartY;
+        position = sqrtf(dx * dx + dy * dy) * setup.Scale + 0.5f;
+    }
+    else if (shape.Kind == GradientKind::Angular)
+    {
+        auto dx    = x - shape.StartX;
+        auto dy    = y - shape.StartY;
+        auto turns = Atan2Approx(dy * setup.DirectionX - dx * setup.DirectionY, dx * setup.DirectionX + dy * setup.DirectionY) * 0.159154937f;
+        turns      = (turns < 0.0f) ? (turns + 1.0f) : turns;
+        position   = turns * setup.Scale + 0.5f;
+    }
+    else
+    {
+        position = x * setup.StepX + (y * setup.StepY + setup.Offset);
+    }
+    return (position < 0.0f) ? 0 : ((position > top) ? (GradientLutSize - 1) : (int32_t)position);
+}
+
+void GetGradientIndices(const GradientShape_t& shape, int32_t x, int32_t y, int32_t count, int32_t* pIndices)
+{
+    ShapeSetup_t setup;
+    SetupShape(shape, &setup);
+    auto py = (float)y + 0.5f;
+    auto i  = 0;
+
+#ifdef GRADIENT_SSE2
+    const auto zero   = _mm_setzero_ps();
+    const auto half   = _mm_set1_ps(0.5f);
+    const auto top    = _mm_set1_ps((float)(GradientLutSize - 1));
+    const auto four   = _mm_set1_ps(4.0f);
+    const auto scale  = _mm_set1_ps(setup.Scale);
+    const auto sign   = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    const auto dirX   = _mm_set1_ps(setup.DirectionX);
+    const auto dirY   = _mm_set1_ps(setup.DirectionY);
+    const auto startX = _mm_set1_ps(shape.StartX);
+    const auto dy     = _mm_set1_ps(py - shape.StartY);
+    const auto rowY   = _mm_set1_ps(py * setup.StepY + setup.Offset);
+    const auto stepX  = _mm_set1_ps(setup.StepX);
+    auto center       = _mm_add_ps(_mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f), _mm_set1_ps((float)x));
+    for (; (i + 4) <= count; i += 4, center = _mm_add_ps(center, four))
+    {
+        __m128 position;
+        if (shape.Kind == GradientKind::Radial)
+        {
+            auto dx  = _mm_sub_ps(center, startX);
+            position = _mm_add_ps(_mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy))), scale), half);
+        }
+        else if (shape.Kind == GradientKind::Angular)
+        {
+            // Rotate so the end direction is angle zero, then the same polynomial as Atan2Approx..
+            auto dx = _mm_sub_ps(center, startX);
+            auto u  = _mm_add_ps(_mm_mul_ps(dx, dirX), _mm_mul_ps(dy, dirY));
+            auto v  = _mm_sub_ps(_mm_mul_ps(dy, dirX), _mm_mul_ps(dx, dirY));
+            auto ax = _mm_andnot_ps(sign, u);
+            auto ay = _mm_andnot_ps(sign, v);
+            auto mn = _mm_min_ps(ax, ay);
+            auto mx = _mm_max_ps(ax, ay);
+            auto z  = _mm_div_ps(mn, _mm_max_ps(mx, _mm_set1_ps(1e-20f)));
+            auto z2 = _mm_mul_ps(z, z);
+            auto a  = _mm_add_ps(_mm_set1_ps(0.05265332f), _mm_mul_ps(z2, _mm_set1_ps(-0.01172120f)));
+            a       = _mm_add_ps(_mm_set1_ps(-0.11643287f), _mm_mul_ps(z2, a));
+            a       = _mm_add_ps(_mm_set1_ps(0.19354346f), _mm_mul_ps(z2, a));
+            a       = _mm_add_ps(_mm_set1_ps(-0.33262347f), _mm_mul_ps(z2, a));
+            a       = _mm_mul_ps(z, _mm_add_ps(_mm_set1_ps(0.99997726f), _mm_mul_ps(z2, a)));
+
+            auto steep    = _mm_cmpgt_ps(ay, ax);
+            a             = _mm_or_ps(_mm_and_ps(steep, _mm_sub_ps(_mm_set1_ps(1.57079637f), a)), _mm_andnot_ps(steep, a));
+            auto behind   = _mm_cmplt_ps(u, zero);
+            a             = _mm_or_ps(_mm_and_ps(behind, _mm_sub_ps(_mm_set1_ps(3.14159274f), a)), _mm_andnot_ps(behind, a));
+            auto negative = _mm_cmplt_ps(v, zero);
+            a             = _mm_xor_ps(a, _mm_and_ps(negative, sign));
+
+            auto turns = _mm_mul_ps(a, _mm_set1_ps(0.159154937f));
+            turns      = _mm_add_ps(turns, _mm_and_ps(_mm_cmplt_ps(turns, zero), _mm_set1_ps(1.0f)));
+            position   = _mm_add_ps(_mm_mul_ps(turns, scale), half);
+        }
+        else
+        {
+            position = _mm_add_ps(_mm_mul_ps(center, stepX), rowY);
+        }
+        _mm_storeu_si128((__m128i*)(pIndices + i), _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(position, zero), top)));
+    }
+#endif
+
+    for (; i < count; i++)
+        pIndices[i] = ShadeIndex(shape, setup, (float)(x + i) + 0.5f, py);
+}
+
+// Source over for non-premultiplied pixels, source alpha already scaled by coverage..
+static inline uint32_t BlendPixel(uint32_t source, uint32_t coverage, uint32_t dest)
+{
+    auto sourceAlpha = ((source >> 24) * coverage + 127) / 255;
+    auto destAlpha   = dest >> 24;
+    if (sourceAlpha == 0)
+        return dest;
+    if (destAlpha == 0)
+        return (source & 0x00FFFFFF) | (sourceAlpha << 24);
+
+    auto under = destAlpha * (255 - sourceAlpha);
+    auto alpha = sourceAlpha * 255 + under;
+    uint32_t result = ((alpha + 127) / 255) << 24;
+    for (auto shift = 0; shift < 24; shift += 8)
+    {
+        auto color = ((source >> shift) & 0xFF) * sourceAlpha * 255 + ((dest >> shift) & 0xFF) * under;
+        result |= ((color + alpha / 2) / alpha) << shift;
+    }
+    return result;
+}
+
+void CompositeGradient(uint8_t* dest, int32_t destPitch, const uint8_t* mask, int32_t maskPitch, int32_t width, int32_t height, const uint32_t* pLut, const GradientShape_t& shape)
+{
+    // Indices are computed a span at a time into a small buffer..
+    alignas(16) int32_t index[256];
+    for (auto y = 0; y < height; y++)
+    {
+        auto out      = (uint32_t*)(dest + (y * destPitch));
+        auto coverage = mask + (y * maskPitch);
+        for (auto spanStart = 0; spanStart < width; spanStart += 256)
+        {
+            auto spanEnd = ((spanStart + 256) < width) ? (spanStart + 256) : width;
+            GetGradientIndices(shape, spanStart, y, spanEnd - spanStart, index);
+            auto spanIndex = index - spanStart;
+            auto x         = spanStart;
+
+#ifdef GRADIENT_SSE2
+            // Spans of empty coverage are skipped without touching the ramp..
+            for (; (x + 4) <= spanEnd; x += 4)
+            {
+                uint32_t covered;
+                memcpy(&covered, coverage + x, 4);
+                if (covered == 0)
+                    continue;
+
+                auto destPixels = _mm_loadu_si128((const __m128i*)(out + x));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_srli_epi32(destPixels, 24), _mm_setzero_si128())) == 0xFFFF)
+                {
+                    // Nothing underneath, the result is the ramp color with alpha scaled by coverage..
+                    auto colors   = _mm_setr_epi32((int)pLut[spanIndex[x]], (int)pLut[spanIndex[x + 1]], (int)pLut[spanIndex[x + 2]], (int)pLut[spanIndex[x + 3]]);
+                    auto alpha    = _mm_srli_epi32(colors, 24);
+                    auto cover    = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)covered), _mm_setzero_si128()), _mm_setzero_si128());
+                    auto product  = _mm_add_epi32(_mm_mullo_epi16(alpha, cover), _mm_set1_epi32(128));
+                    auto scaled   = _mm_srli_epi32(_mm_add_epi32(product, _mm_srli_epi32(product, 8)), 8);
+                    auto visible  = _mm_cmpgt_epi32(scaled, _mm_setzero_si128());
+                    auto combined = _mm_or_si128(_mm_and_si128(colors, _mm_set1_epi32(0x00FFFFFF)), _mm_slli_epi32(scaled, 24));
+                    _mm_storeu_si128((__m128i*)(out + x), _mm_or_si128(_mm_and_si128(visible, combined), _mm_andnot_si128(visible, destPixels)));
+                    continue;
+                }
+
+                for (auto i = 0; i < 4; i++)
+                    out[x + i] = BlendPixel(pLut[spanIndex[x + i]], coverage[x + i], out[x + i]);
+            }
+#endif
+
+            for (; x < spanEnd; x++)
+            {
+                if (coverage[x] != 0)
+                    out[x] = BlendPixel(pLut[spanIndex[x]], coverage[x], out[x]);
+            }
+        }
+    }
+}
\ No newline at end of file
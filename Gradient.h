@@ -0,0 +1,50 @@
+#ifndef __Gradient_H_INCLUDED__
+#define __Gradient_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include <stdint.h>
+
+// Entries in a color ramp, enough that neighbouring entries differ by at most one step per channel.
+constexpr int32_t GradientLutSize = 256;
+
+enum class GradientKind : uint32_t
+{
+    Linear,  // Along the line from start to end.
+    Radial,  // Outwards from start, reaching the end of the ramp at the distance of end.
+    Angular, // Clockwise around start, beginning in the direction of end.
+};
+
+// Where a gradient sits, in pixel coordinates.
+struct GradientShape_t
+{
+    GradientKind Kind;
+    float StartX;
+    float StartY;
+    float EndX;
+    float EndY;
+};
+
+struct GradientStop_t
+{
+    float Position; // 0 to 1, ascending.
+    uint32_t Color;
+};
+
+// Maps GradientStyle 1-8 onto a linear gradient across a width x height box, corner to corner or edge to edge.
+// Unknown styles run left to right.
+void GetGradientLine(uint32_t style, int32_t width, int32_t height, GradientShape_t* pShape);
+
+// Fills a ramp through the stops (A8R8G8B8, not premultiplied), each channel interpolated linearly between
+// neighbouring stops. Positions before the first or after the last stop take its color.
+void BuildGradientRamp(const GradientStop_t* stops, uint32_t stopCount, uint32_t* pLut);
+void BuildGradientLut(uint32_t startColor, uint32_t endColor, uint32_t* pLut);
+
+// Ramp index for count pixel centers of row y, starting at column x.
+void GetGradientIndices(const GradientShape_t& shape, int32_t x, int32_t y, int32_t count, int32_t* pIndices);
+
+// Composites the ramp over width x height A8R8G8B8 pixels, using an 8 bit coverage mask as the source alpha.
+void CompositeGradient(uint8_t* dest, int32_t destPitch, const uint8_t* mask, int32_t maskPitch, int32_t width, int32_t height, const uint32_t* pLut, const GradientShape_t& shape);
+#endif
\ No newline at end of file
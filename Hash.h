@@ -0,0 +1,30 @@
+#ifndef __Hash_H_INCLUDED__
+#define __Hash_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 64 bit FNV-1a, chain calls by passing the previous result as the seed.
+constexpr uint64_t HashSeed = 0xCBF29CE484222325ull;
+
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = HashSeed)
+{
+    auto bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        seed ^= bytes[i];
+        seed *= 0x100000001B3ull;
+    }
+    return seed;
+}
+
+template <typename T>
+inline uint64_t HashValue(const T& value, uint64_t seed)
+{
+    return HashBytes(&value, sizeof(T), seed);
+}
+#endif
@@ -0,0 +1,172 @@
+#include "MarkupParser.h"
+
+static bool Matches(const uint16_t* text, const uint16_t* end, const char* name)
+{
+    for (; *name; text++, name++)
+    {
+        if ((text == end) || (*text != (uint16_t)*name))
+            return false;
+    }
+    return text == end;
+}
+
+static bool ParseHex(const uint16_t* text, const uint16_t* end, uint32_t* pValue)
+{
+    auto digits = end - text;
+    if ((digits != 6) && (digits != 8))
+        return false;
+
+    uint32_t value = 0;
+    for (; text < end; text++)
+    {
+        auto c = *text;
+        if ((c >= '0') && (c <= '9'))
+            value = (value << 4) | (c - '0');
+        else if ((c >= 'a') && (c <= 'f'))
+            value = (value << 4) | (c - 'a' + 10);
+        else if ((c >= 'A') && (c <= 'F'))
+            value = (value << 4) | (c - 'A' + 10);
+        else
+            return false;
+    }
+    *pValue = (digits == 6) ? (value | 0xFF000000) : value;
+    return true;
+}
+
+static bool ParseSize(const uint16_t* text, const uint16_t* end, float* pValue)
+{
+    float value    = 0.0f;
+    float scale    = 0.0f;
+    bool hasDigits = false;
+    for (; text < end; text++)
+    {
+        auto c = *text;
+        if ((c == '.') && (scale == 0.0f))
+        {
+            scale = 0.1f;
+        }
+        else if ((c >= '0') && (c <= '9'))
+        {
+            if (scale == 0.0f)
+            {
+                value = (value * 10.0f) + (float)(c - '0');
+            }
+            else
+            {
+                value += scale * (float)(c - '0');
+                scale *= 0.1f;
+            }
+            hasDigits = true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    if (!hasDigits || (value <= 0.0f))
+        return false;
+    *pValue = value;
+    return true;
+}
+
+MarkupParser::MarkupParser(const uint16_t* text, uint32_t length, const MarkupStyle_t& base)
+    : m_Cursor(text)
+    , m_End(text + length)
+    , m_Depth(1)
+    , m_Overflow(0)
+    , m_NewLine(false)
+    , m_LineHasRun(false)
+{
+    m_Stack[0] = base;
+}
+
+// Applies the tag at the cursor and moves past it, or returns false if it isn't one..
+bool MarkupParser::ParseTag()
+{
+    const uint32_t maxLength = 32;
+    auto start               = m_Cursor + 1;
+    auto close               = start;
+    while ((close < m_End) && (*close != '>') && ((uint32_t)(close - start) < maxLength))
+        close++;
+    if ((close == m_End) || (*close != '>') || (close == start))
+        return false;
+
+    // Closing tags don't have to name what they close..
+    if (*start == '/')
+    {
+        if (m_Overflow)
+            m_Overflow--;
+        else if (m_Depth > 1)
+            m_Depth--;
+        m_Cursor = close + 1;
+        return true;
+    }
+
+    auto style = m_Stack[m_Depth - 1];
+    if (Matches(start, close, "b"))
+        style.Flags |= MarkupBold;
+    else if (Matches(start, close, "i"))
+        style.Flags |= MarkupItalic;
+    else if (Matches(start, close, "u"))
+        style.Flags |= MarkupUnderline;
+    else if (!(((close - start) > 2) && Matches(start, start + 2, "c=") && ParseHex(start + 2, close, &style.Color)) && !(((close - start) > 5) && Matches(start, start + 5, "size=") && ParseSize(start + 5, close, &style.Size)))
+        return false;
+
+    if (m_Depth < MaxDepth)
+        m_Stack[m_Depth++] = style;
+    else
+        m_Overflow++;
+    m_Cursor = close + 1;
+    return true;
+}
+
+void MarkupParser::Emit(MarkupRun_t* pRun, const uint16_t* text, uint32_t length)
+{
+    pRun->Text    = text;
+    pRun->Length  = length;
+    pRun->Style   = m_Stack[m_Depth - 1];
+    pRun->NewLine = m_NewLine;
+    m_NewLine     = false;
+    m_LineHasRun  = true;
+}
+
+// Returns the next run, runs never hold a line break..
+bool MarkupParser::Next(MarkupRun_t* pRun)
+{
+    while (m_Cursor < m_End)
+    {
+        if (*m_Cursor == '\n')
+        {
+            // A line with no text still comes through as an empty run so it takes up space..
+            auto empty = !m_LineHasRun;
+            if (empty)
+                Emit(pRun, m_Cursor, 0);
+            m_Cursor++;
+            m_NewLine    = true;
+            m_LineHasRun = false;
+            if (empty)
+                return true;
+            continue;
+        }
+
+        auto start = m_Cursor;
+        if (*m_Cursor == '<')
+        {
+            if (((m_Cursor + 1) < m_End) && (m_Cursor[1] == '<'))
+            {
+                m_Cursor += 2;
+                Emit(pRun, start, 1);
+                return true;
+            }
+            if (ParseTag())
+                continue;
+            m_Cursor++;
+        }
+
+        while ((m_Cursor < m_End) && (*m_Cursor != '<') && (*m_Cursor != '\n'))
+            m_Cursor++;
+        Emit(pRun, start, (uint32_t)(m_Cursor - start));
+        return true;
+    }
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#ifndef __MarkupParser_H_INCLUDED__
+#define __MarkupParser_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include <stdint.h>
+
+// Style bits, the same values as gdiplus FontStyle.
+constexpr int32_t MarkupBold      = 1;
+constexpr int32_t MarkupItalic    = 2;
+constexpr int32_t MarkupUnderline = 4;
+
+struct MarkupStyle_t
+{
+    uint32_t Color; // ARGB.
+    float Size;     // Em size in pixels.
+    int32_t Flags;
+};
+
+// Text in a single style, pointing into the parsed string.
+struct MarkupRun_t
+{
+    const uint16_t* Text;
+    uint32_t Length;
+    MarkupStyle_t Style;
+    bool NewLine; // Starts a line other than the first, lines without text come through as empty runs.
+};
+
+// Splits UTF-16 text into styled runs one at a time without allocating. Tags are <b>, <i>, <u>, <c=RRGGBB>,
+// <c=AARRGGBB> and <size=N>, any closing tag such as </b> or </> undoes the latest one and << is a literal <.
+// Anything else in angle brackets is left in the text. The parser is a plain value, copying it saves the
+// position so a line can be read twice.
+class MarkupParser
+{
+private:
+    static const uint32_t MaxDepth = 16;
+
+    const uint16_t* m_Cursor;
+    const uint16_t* m_End;
+    MarkupStyle_t m_Stack[MaxDepth];
+    uint32_t m_Depth;
+    uint32_t m_Overflow; // Tags nested past MaxDepth, they change nothing but still need closing.
+    bool m_NewLine;
+    bool m_LineHasRun;
+
+    bool ParseTag();
+    void Emit(MarkupRun_t* pRun, const uint16_t* text, uint32_t length);
+
+public:
+    MarkupParser(const uint16_t* text, uint32_t length, const MarkupStyle_t& base);
+    bool Next(MarkupRun_t* pRun);
+};
+#endif
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "MaskBlur.h"
+#include <math.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define MASKBLUR_SSE2
+#endif
+
+// The box each of the three passes uses, a third of the gaussian variance apiece. Whole boxes come in coarse
+// steps and round down to nothing for small radii, so the box also takes its two outer neighbours at a
+// fractional weight that makes up the rest. A box of radius r has a variance of r(r + 1) / 3..
+static void GetBox(float radius, int32_t* pRadius, float* pEdgeWeight)
+{
+    auto sigma    = (radius > 0.0f) ? (radius * 0.5f) : 0.0f;
+    auto variance = (sigma * sigma) / 3.0f;
+    auto box      = (int32_t)((0.5f * sqrtf((12.0f * variance) + 1.0f)) - 0.5f);
+    auto edge     = ((float)((2 * box) + 1) * ((float)(box * (box + 1)) - (3.0f * variance))) / (6.0f * (variance - (float)((box + 1) * (box + 1))));
+    *pRadius      = box;
+    *pEdgeWeight  = (edge <= 0.0f) ? 0.0f : ((edge >= 1.0f) ? 1.0f : edge);
+}
+
+#ifdef MASKBLUR_SSE2
+static inline void AddRow(__m128i* pSum, const uint8_t* row)
+{
+    auto zero  = _mm_setzero_si128();
+    auto value = _mm_loadu_si128((const __m128i*)row);
+    auto low   = _mm_unpacklo_epi8(value, zero);
+    auto high  = _mm_unpackhi_epi8(value, zero);
+    pSum[0]    = _mm_add_epi32(pSum[0], _mm_unpacklo_epi16(low, zero));
+    pSum[1]    = _mm_add_epi32(pSum[1], _mm_unpackhi_epi16(low, zero));
+    pSum[2]    = _mm_add_epi32(pSum[2], _mm_unpacklo_epi16(high, zero));
+    pSum[3]    = _mm_add_epi32(pSum[3], _mm_unpackhi_epi16(high, zero));
+}
+
+static inline void SubtractRow(__m128i* pSum, const uint8_t* row)
+{
+    auto zero  = _mm_setzero_si128();
+    auto value = _mm_loadu_si128((const __m128i*)row);
+    auto low   = _mm_unpacklo_epi8(value, zero);
+    auto high  = _mm_unpackhi_epi8(value, zero);
+    pSum[0]    = _mm_sub_epi32(pSum[0], _mm_unpacklo_epi16(low, zero));
+    pSum[1]    = _mm_sub_epi32(pSum[1], _mm_unpackhi_epi16(low, zero));
+    pSum[2]    = _mm_sub_epi32(pSum[2], _mm_unpacklo_epi16(high, zero));
+    pSum[3]    = _mm_sub_epi32(pSum[3], _mm_unpackhi_epi16(high, zero));
+}
+
+static inline __m128i AverageSum(__m128i sum, __m128i edge, __m128 edgeWeight, __m128 scale)
+{
+    auto total = _mm_add_ps(_mm_cvtepi32_ps(sum), _mm_mul_ps(_mm_cvtepi32_ps(edge), edgeWeight));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(total, scale), _mm_set1_ps(0.5f)));
+}
+#endif
+
+// One box pass down every column. A running sum gains the row entering the window and loses the row
+// leaving it, so the cost per pixel does not depend on the radius. The rows just outside the window are
+// added at edgeWeight, zero gives a plain box..
+static void BoxBlurColumns(uint8_t* dest, const uint8_t* source, int32_t width, int32_t height, int32_t radius, float edgeWeight)
+{
+    auto scale = 1.0f / ((float)((radius * 2) + 1) + (2.0f * edgeWeight));
+    auto x     = 0;
+
+#ifdef MASKBLUR_SSE2
+    auto scale4 = _mm_set1_ps(scale);
+    auto weight = _mm_set1_ps(edgeWeight);
+    for (; (x + 16) <= width; x += 16)
+    {
+        __m128i sum[4] = { _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128() };
+        for (auto y = 0; (y < radius) && (y < height); y++)
+            AddRow(sum, source + (y * width) + x);
+
+        for (auto y = 0; y < height; y++)
+        {
+            if ((y + radius) < height)
+                AddRow(sum, source + ((y + radius) * width) + x);
+            if ((y - radius - 1) >= 0)
+                SubtractRow(sum, source + ((y - radius - 1) * width) + x);
+
+            __m128i edge[4] = { _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128() };
+            if (edgeWeight > 0.0f)
+            {
+                if ((y + radius + 1) < height)
+                    AddRow(edge, source + ((y + radius + 1) * width) + x);
+                if ((y - radius - 1) >= 0)
+                    AddRow(edge, source + ((y - radius - 1) * width) + x);
+            }
+
+            auto low  = _mm_packs_epi32(AverageSum(sum[0], edge[0], weight, scale4), AverageSum(sum[1], edge[1], weight, scale4));
+            auto high = _mm_packs_epi32(AverageSum(sum[2], edge[2], weight, scale4), AverageSum(sum[3], edge[3], weight, scale4));
+            _mm_storeu_si128((__m128i*)(dest + (y * width) + x), _mm_packus_epi16(low, high));
+        }
+    }
+#endif
+
+    for (; x < width; x++)
+    {
+        int32_t sum = 0;
+        for (auto y = 0; (y < radius) && (y < height); y++)
+            sum += source[(y * width) + x];
+
+        for (auto y = 0; y < height; y++)
+        {
+            if ((y + radius) < height)
+                sum += source[((y + radius) * width) + x];
+            if ((y - radius - 1) >= 0)
+                sum -= source[((y - radius - 1) * width) + x];
+
+            int32_t edge = 0;
+            if ((y + radius + 1) < height)
+                edge += source[((y + radius + 1) * width) + x];
+            if ((y - radius - 1) >= 0)
+                edge += source[((y - radius - 1) * width) + x];
+            dest[(y * width) + x] = (uint8_t)(int32_t)((((float)sum + ((float)edge * edgeWeight)) * scale) + 0.5f);
+        }
+    }
+}
+
+// Writes the height x width transpose of source, in tiles so both sides stay in cache..
+static void TransposeMask(uint8_t* dest, const uint8_t* source, int32_t width, int32_t height)
+{
+    const int32_t tile = 32;
+    for (auto tileY = 0; tileY < height; tileY += tile)
+    {
+        auto endY = ((tileY + tile) < height) ? (tileY + tile) : height;
+        for (auto tileX = 0; tileX < width; tileX += tile)
+        {
+            auto endX = ((tileX + tile) < width) ? (tileX + tile) : width;
+            for (auto y = tileY; y < endY; y++)
+            {
+                for (auto x = tileX; x < endX; x++)
+                    dest[(x * height) + y] = source[(y * width) + x];
+            }
+        }
+    }
+}
+
+void BlurMask(uint8_t* mask, uint8_t* scratch, int32_t width, int32_t height, float radius)
+{
+    int32_t box;
+    float edgeWeight;
+    GetBox(radius, &box, &edgeWeight);
+    if ((width <= 0) || (height <= 0) || ((box == 0) && (edgeWeight == 0.0f)))
+        return;
+
+    // Rows are blurred as columns of the transposed mask, so only the column pass needs to be fast..
+    BoxBlurColumns(scratch, mask, width, height, box, edgeWeight);
+    BoxBlurColumns(mask, scratch, width, height, box, edgeWeight);
+    BoxBlurColumns(scratch, mask, width, height, box, edgeWeight);
+    TransposeMask(mask, scratch, width, height);
+    BoxBlurColumns(scratch, mask, height, width, box, edgeWeight);
+    BoxBlurColumns(mask, scratch, height, width, box, edgeWeight);
+    BoxBlurColumns(scratch, mask, height, width, box, edgeWeight);
+    TransposeMask(mask, scratch, height, width);
+}
+
+int32_t GetBlurExtent(float radius)
+{
+    int32_t box;
+    float edgeWeight;
+    GetBox(radius, &box, &edgeWeight);
+    return 3 * (box + ((edgeWeight > 0.0f) ? 1 : 0));
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#ifndef __MaskBlur_H_INCLUDED__
+#define __MaskBlur_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include <stdint.h>
+
+// Blurs an 8 bit coverage mask in place with three box passes in each direction, which approximates a gaussian
+// with a sigma of half the radius. Each box weighs in its outer neighbours fractionally, so any radius above
+// zero blurs. Mask and scratch are width * height bytes with no row padding, pixels outside the mask
+// count as empty. Each pass costs the same whatever the radius.
+void BlurMask(uint8_t* mask, uint8_t* scratch, int32_t width, int32_t height, float radius);
+
+// How many pixels BlurMask can spread coverage past the edge of a shape..
+int32_t GetBlurExtent(float radius);
+#endif
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "MaskDilation.h"
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+static const float FarDistance = 1e20f;
+static const int16_t FarRows    = INT16_MAX;
+
+void DilateMask(uint8_t* dest, int32_t destPitch, const uint8_t* mask, int32_t maskPitch, int32_t width, int32_t height, float radius, int16_t* pScratch)
+{
+    if ((width <= 0) || (height <= 0))
+        return;
+
+    // Columns first, distance to the nearest covered pixel above or below and which row it is in. Sweeps run
+    // row by row with the nearest row per column carried along, which keeps memory access sequential..
+    auto columnDistance = pScratch;
+    auto seedRow        = pScratch + ((size_t)width * height);
+    std::vector<int32_t> nearest(width, -1);
+    for (auto y = 0; y < height; y++)
+    {
+        auto maskRow = mask + (y * maskPitch);
+        auto offset  = y * width;
+        for (auto x = 0; x < width; x++)
+        {
+            if (maskRow[x] != 0)
+                nearest[x] = y;
+            columnDistance[offset + x] = (nearest[x] < 0) ? FarRows : (int16_t)(y - nearest[x]);
+            seedRow[offset + x]        = (int16_t)nearest[x];
+        }
+    }
+
+    nearest.assign(width, -1);
+    for (auto y = height - 1; y >= 0; y--)
+    {
+        auto maskRow = mask + (y * maskPitch);
+        auto offset  = y * width;
+        for (auto x = 0; x < width; x++)
+        {
+            if (maskRow[x] != 0)
+                nearest[x] = y;
+            if ((nearest[x] >= 0) && ((nearest[x] - y) < columnDistance[offset + x]))
+            {
+                columnDistance[offset + x] = (int16_t)(nearest[x] - y);
+                seedRow[offset + x]        = (int16_t)nearest[x];
+            }
+        }
+    }
+
+    // Then rows, the lower envelope of the parabolas (x - q)^2 + g(q)^2 gives the nearest covered pixel in 2d..
+    std::vector<int32_t> vertex(width);
+    std::vector<float> boundary(width + 1);
+    std::vector<float> height2(width);
+    for (auto y = 0; y < height; y++)
+    {
+        auto row = columnDistance + (y * width);
+        for (auto x = 0; x < width; x++)
+            height2[x] = (row[x] == FarRows) ? FarDistance : ((float)row[x] * row[x]);
+
+        // Rows without any covered pixel in reach stay empty..
+        auto out   = dest + (y * destPitch);
+        auto first = 0;
+        while ((first < width) && (height2[first] >= FarDistance))
+            first++;
+        if (first == width)
+        {
+            memset(out, 0, width);
+            continue;
+        }
+
+        int32_t count = 0;
+        vertex[0]     = first;
+        boundary[0]   = -FarDistance;
+        boundary[1]   = FarDistance;
+        for (auto q = first + 1; q < width; q++)
+        {
+            if (height2[q] >= FarDistance)
+                continue;
+
+            // Drop parabolas the new one hides, boundary[0] is minus infinity so the first always stays..
+            float s;
+            while (true)
+            {
+                auto v = vertex[count];
+                s      = ((height2[q] + (float)q * q) - (height2[v] + (float)v * v)) / (float)(2 * (q - v));
+                if (s > boundary[count])
+                    break;
+                count--;
+            }
+            count++;
+            vertex[count]       = q;
+            boundary[count]     = s;
+            boundary[count + 1] = FarDistance;
+        }
+
+        int32_t k = 0;
+        for (auto x = 0; x < width; x++)
+        {
+            while (boundary[k + 1] < (float)x)
+                k++;
+
+            // Edge sits inside the nearest covered pixel by how much of it is covered..
+            auto sx       = vertex[k];
+            auto sy       = seedRow[y * width + sx];
+            auto dx       = (float)(x - sx);
+            auto distance = sqrtf(dx * dx + height2[sx]);
+            auto edge     = (float)mask[sy * maskPitch + sx] / 255.0f - 0.5f;
+            auto coverage = radius + 0.5f - (distance - edge);
+            out[x]        = (coverage <= 0.0f) ? 0 : ((coverage >= 1.0f) ? 255 : (uint8_t)(coverage * 255.0f + 0.5f));
+        }
+    }
+}
\ No newline at end of file
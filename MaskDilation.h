@@ -0,0 +1,15 @@
+#ifndef __MaskDilation_H_INCLUDED__
+#define __MaskDilation_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include <stdint.h>
+
+// Grows an 8 bit coverage mask by radius pixels, writing the coverage of the grown shape to dest.
+// Uses an exact euclidean distance transform, so the cost depends on the pixel count and not on the radius.
+// Partially covered mask pixels move the edge by their coverage, which keeps the result anti-aliased.
+// pScratch holds 2 * width * height values and masks can be up to 32767 rows tall.
+void DilateMask(uint8_t* dest, int32_t destPitch, const uint8_t* mask, int32_t maskPitch, int32_t width, int32_t height, float radius, int16_t* pScratch);
+#endif
\ No newline at end of file
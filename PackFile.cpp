@@ -0,0 +1,286 @@
+#include "PackFile.h"
+#include "Hash.h"
+#include <filesystem>
+#include <string.h>
+
+#ifdef _WIN32
+#include <share.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static constexpr uint32_t PackMagic   = 0x50544647; // 'GFTP'
+static constexpr uint32_t PackVersion = 1;
+static constexpr uint32_t RecordMagic = 0x52544647; // 'GFTR'
+static constexpr uint64_t PackSizeCap = 1024ull * 1024 * 1024;
+static constexpr int32_t MaxDimension = 4096;
+
+struct PackHeader_t
+{
+    uint32_t Magic;
+    uint32_t Version;
+};
+
+struct PackRecord_t
+{
+    uint32_t Magic;
+    uint32_t Checksum;
+    uint64_t Key;
+    int32_t Width;
+    int32_t Height;
+    uint32_t Size;
+    uint32_t Reserved;
+};
+
+static uint32_t RecordChecksum(const PackRecord_t& record, const uint8_t* pixels)
+{
+    auto hash = HashValue(record.Key, HashSeed);
+    hash      = HashValue(record.Width, hash);
+    hash      = HashValue(record.Height, hash);
+    hash      = HashBytes(pixels, record.Size, hash);
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+// Paths are UTF-8, on Windows they go through the wide file apis so they aren't limited to the ANSI code page.
+// The file stays shared, the reader opens it again while the writer is open..
+static FILE* OpenFile(const std::filesystem::path& path, const char* mode)
+{
+#ifdef _WIN32
+    wchar_t wideMode[8] = {};
+    for (auto i = 0; (i < 7) && mode[i]; i++)
+        wideMode[i] = (wchar_t)mode[i];
+    return _wfsopen(path.c_str(), wideMode, _SH_DENYNO);
+#else
+    return fopen(path.c_str(), mode);
+#endif
+}
+
+static bool RecordValid(const PackRecord_t& record)
+{
+    return (record.Magic == RecordMagic) && (record.Width > 0) && (record.Height > 0) && (record.Width <= MaxDimension) && (record.Height <= MaxDimension) && (record.Size == (uint32_t)(record.Width * record.Height * 4));
+}
+
+PackFile::PackFile()
+    : m_Writer(nullptr)
+    , m_FileSize(0)
+    , m_MaxSize(0)
+    , m_Reader(-1)
+{}
+
+PackFile::~PackFile()
+{
+    Close();
+}
+
+bool PackFile::Open(const char* path, uint64_t maxSize)
+{
+    Close();
+    m_Path    = std::filesystem::path((const char8_t*)path);
+    m_MaxSize = (maxSize < PackSizeCap) ? maxSize : PackSizeCap;
+
+    // Walk the record headers, anything after the first bad or truncated record is discarded..
+    uint64_t validSize = 0;
+    FILE* reader       = OpenFile(m_Path, "rb");
+    if (reader)
+    {
+        std::error_code error;
+        auto fileSize = (uint64_t)std::filesystem::file_size(m_Path, error);
+        PackHeader_t header{};
+        if (!error && (fread(&header, sizeof(header), 1, reader) == 1) && (header.Magic == PackMagic) && (header.Version == PackVersion))
+        {
+            validSize = sizeof(header);
+            PackRecord_t record{};
+            while (fread(&record, sizeof(record), 1, reader) == 1)
+            {
+                auto recordEnd = validSize + sizeof(record) + record.Size;
+                if (!RecordValid(record) || (recordEnd > fileSize))
+                    break;
+
+                m_Index[record.Key] = IndexEntry_t{validSize, false};
+                validSize           = recordEnd;
+                if (fseek(reader, (long)validSize, SEEK_SET) != 0)
+                    break;
+            }
+        }
+        fclose(reader);
+
+        if (validSize == 0)
+            m_Index.clear();
+        if (error || (validSize != fileSize))
+            std::filesystem::resize_file(m_Path, validSize, error);
+    }
+
+    // New or unreadable pack, start over with just a header..
+    if (validSize == 0)
+    {
+        FILE* writer = OpenFile(m_Path, "wb");
+        if (!writer)
+            return false;
+        PackHeader_t header{PackMagic, PackVersion};
+        auto written = fwrite(&header, sizeof(header), 1, writer);
+        fclose(writer);
+        if (written != 1)
+            return false;
+        validSize = sizeof(header);
+    }
+
+    m_FileSize = validSize;
+    m_Writer   = OpenFile(m_Path, "ab");
+    if (!m_Writer || !OpenReader())
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void PackFile::Close()
+{
+    CloseReader();
+    if (m_Writer)
+    {
+        fclose(m_Writer);
+        m_Writer = nullptr;
+    }
+    m_Index.clear();
+    m_Pixels.clear();
+    m_Pixels.shrink_to_fit();
+    m_FileSize = 0;
+}
+
+bool PackFile::Find(uint64_t key, int32_t* width, int32_t* height, const uint8_t** pixels)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto iter = m_Index.find(key);
+    if (iter == m_Index.end())
+        return false;
+
+    // Read the header first so a damaged size can't make us read past the record..
+    auto offset = iter->second.Offset;
+    PackRecord_t record;
+    if (!ReadAt(offset, &record, sizeof(record)) || !RecordValid(record) || (record.Key != key) || ((offset + sizeof(record) + record.Size) > m_FileSize))
+    {
+        m_Index.erase(iter);
+        return false;
+    }
+
+    m_Pixels.resize(record.Size);
+    auto data = m_Pixels.data();
+    if (!ReadAt(offset + sizeof(record), data, record.Size))
+    {
+        m_Index.erase(iter);
+        return false;
+    }
+    if (!iter->second.Verified)
+    {
+        if (RecordChecksum(record, data) != record.Checksum)
+        {
+            m_Index.erase(iter);
+            return false;
+        }
+        iter->second.Verified = true;
+    }
+
+    *width  = record.Width;
+    *height = record.Height;
+    *pixels = data;
+    return true;
+}
+
+bool PackFile::Insert(uint64_t key, int32_t width, int32_t height, const uint8_t* pixels, int32_t pitch)
+{
+    if ((m_Writer == nullptr) || (width <= 0) || (height <= 0) || (width > MaxDimension) || (height > MaxDimension))
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    PackRecord_t record{};
+    record.Magic  = RecordMagic;
+    record.Key    = key;
+    record.Width  = width;
+    record.Height = height;
+    record.Size   = (uint32_t)(width * height * 4);
+    if ((m_FileSize + sizeof(record) + record.Size) > m_MaxSize)
+        return false;
+
+    // Checksum the rows as they will be laid out in the file..
+    auto rowBytes = (size_t)width * 4;
+    auto hash     = HashValue(record.Key, HashSeed);
+    hash          = HashValue(record.Width, hash);
+    hash          = HashValue(record.Height, hash);
+    for (auto y = 0; y < height; y++)
+        hash = HashBytes(pixels + (y * pitch), rowBytes, hash);
+    record.Checksum = (uint32_t)(hash ^ (hash >> 32));
+
+    auto ok = (fwrite(&record, sizeof(record), 1, m_Writer) == 1);
+    for (auto y = 0; ok && (y < height); y++)
+        ok = (fwrite(pixels + (y * pitch), rowBytes, 1, m_Writer) == 1);
+    ok = ok && (fflush(m_Writer) == 0);
+
+    // A partial write leaves a bad tail that the next Open will trim, stop writing for this session..
+    if (!ok)
+    {
+        fclose(m_Writer);
+        m_Writer = nullptr;
+        return false;
+    }
+
+    m_Index[key] = IndexEntry_t{m_FileSize, true};
+    m_FileSize += sizeof(record) + record.Size;
+    return true;
+}
+
+bool PackFile::OpenReader()
+{
+#ifdef _WIN32
+    auto file = ::CreateFileW(m_Path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    m_Reader = (intptr_t)file;
+#else
+    auto file = ::open(m_Path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+    m_Reader = file;
+#endif
+    return true;
+}
+
+void PackFile::CloseReader()
+{
+    if (m_Reader == -1)
+        return;
+#ifdef _WIN32
+    ::CloseHandle((HANDLE)m_Reader);
+#else
+    ::close((int)m_Reader);
+#endif
+    m_Reader = -1;
+}
+
+// Reads size bytes at offset without moving a shared file position..
+bool PackFile::ReadAt(uint64_t offset, void* dest, uint32_t size)
+{
+    if (m_Reader == -1)
+        return false;
+#ifdef _WIN32
+    OVERLAPPED overlapped{};
+    overlapped.Offset     = (DWORD)offset;
+    overlapped.OffsetHigh = (DWORD)(offset >> 32);
+    DWORD read            = 0;
+    return ::ReadFile((HANDLE)m_Reader, dest, size, &read, &overlapped) && (read == size);
+#else
+    auto bytes = (uint8_t*)dest;
+    while (size > 0)
+    {
+        auto read = ::pread((int)m_Reader, bytes, size, (off_t)offset);
+        if (read <= 0)
+            return false;
+        bytes  += read;
+        offset += (uint64_t)read;
+        size   -= (uint32_t)read;
+    }
+    return true;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef __PackFile_H_INCLUDED__
+#define __PackFile_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include <stdint.h>
+#include <filesystem>
+#include <mutex>
+#include <stdio.h>
+#include <unordered_map>
+#include <vector>
+
+// Append-only file of A8R8G8B8 bitmaps keyed by a 64 bit hash. Records are read back one at a time with positioned
+// reads, so only the record being looked up takes memory no matter how large the file grows.
+// Records are only appended, a later record with the same key replaces the earlier one. A damaged or truncated tail is
+// cut off when the file is opened, and each record's checksum is verified the first time it is read.
+// Find and Insert may be called from any thread, Open and Close only while nothing else uses the file.
+class PackFile
+{
+private:
+    struct IndexEntry_t
+    {
+        uint64_t Offset;
+        bool Verified;
+    };
+
+    std::filesystem::path m_Path;
+    FILE* m_Writer;
+    uint64_t m_FileSize;
+    uint64_t m_MaxSize;
+    intptr_t m_Reader; // HANDLE on Windows, file descriptor elsewhere. -1 when closed.
+    std::vector<uint8_t> m_Pixels; // Last record found, handed out by Find.
+    std::unordered_map<uint64_t, IndexEntry_t> m_Index;
+    std::mutex m_Mutex;
+
+public:
+    PackFile();
+    ~PackFile();
+    bool Open(const char* path, uint64_t maxSize); // Path is UTF-8.
+    void Close();
+    // Pixels stay valid until the next Find, inserts leave them alone..
+    bool Find(uint64_t key, int32_t* width, int32_t* height, const uint8_t** pixels);
+    bool Insert(uint64_t key, int32_t width, int32_t height, const uint8_t* pixels, int32_t pitch);
+
+private:
+    bool OpenReader();
+    void CloseReader();
+    bool ReadAt(uint64_t offset, void* dest, uint32_t size);
+};
+#endif
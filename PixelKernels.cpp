@@ -0,0 +1,488 @@
+#include "PixelKernels.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define PIXELKERNELS_SSE2
+#else
+#include <math.h>
+#endif
+
+// Exact (x + 127) / 255 for x in [0, 65025]..
+static inline uint32_t Div255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+static inline uint32_t PremultiplyPixel(uint32_t px)
+{
+    auto alpha = px >> 24;
+    auto red   = Div255(((px >> 16) & 0xFF) * alpha);
+    auto green = Div255(((px >> 8) & 0xFF) * alpha);
+    auto blue  = Div255((px & 0xFF) * alpha);
+    return (alpha << 24) | (red << 16) | (green << 8) | blue;
+}
+
+// 4x4 Bayer matrix scaled to [0, 255), used as the rounding bias when dithering..
+static const uint16_t g_Bayer[4][4] = {
+    {8, 136, 40, 168},
+    {200, 72, 232, 104},
+    {56, 184, 24, 152},
+    {248, 120, 216, 88},
+};
+
+// Per-format quantization: channel = (v * Scale + bias) / 255, packed = sum(channel * Weight) (b, g, r, a order)..
+struct QuantizeFormat_t
+{
+    int16_t Scale[4];
+    int16_t Weight[4];
+    uint16_t AlphaBias;
+};
+
+static const QuantizeFormat_t g_A4R4G4B4 = {{15, 15, 15, 15}, {1, 16, 256, 4096}, 127};
+static const QuantizeFormat_t g_A1R5G5B5 = {{31, 31, 31, 1}, {1, 32, 1024, -32768}, 127};
+
+// Exact floor(x / 255) for x in [0, 65534]..
+static inline uint32_t Floor255(uint32_t x)
+{
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+static inline uint16_t QuantizePixel(uint32_t px, const QuantizeFormat_t& format, uint16_t bias)
+{
+    uint32_t packed = 0;
+    for (auto c = 0; c < 4; c++)
+    {
+        auto value = (px >> (c * 8)) & 0xFF;
+        auto level = Floor255(value * format.Scale[c] + ((c == 3) ? format.AlphaBias : bias));
+        packed += level * (uint32_t)format.Weight[c];
+    }
+    return (uint16_t)packed;
+}
+
+static void CopyRow(uint8_t* dest, const uint8_t* source, int32_t bytes, bool streaming)
+{
+#ifdef PIXELKERNELS_SSE2
+    if (streaming)
+    {
+        // Rows are at least pixel aligned, walk forward until the destination is 16 byte aligned..
+        while ((((uintptr_t)dest) & 15) && (bytes >= 4))
+        {
+            memcpy(dest, source, 4);
+            dest += 4;
+            source += 4;
+            bytes -= 4;
+        }
+        while (bytes >= 64)
+        {
+            auto a = _mm_loadu_si128((const __m128i*)(source));
+            auto b = _mm_loadu_si128((const __m128i*)(source + 16));
+            auto c = _mm_loadu_si128((const __m128i*)(source + 32));
+            auto d = _mm_loadu_si128((const __m128i*)(source + 48));
+            _mm_stream_si128((__m128i*)(dest), a);
+            _mm_stream_si128((__m128i*)(dest + 16), b);
+            _mm_stream_si128((__m128i*)(dest + 32), c);
+            _mm_stream_si128((__m128i*)(dest + 48), d);
+            dest += 64;
+            source += 64;
+            bytes -= 64;
+        }
+        while (bytes >= 16)
+        {
+            _mm_stream_si128((__m128i*)dest, _mm_loadu_si128((const __m128i*)source));
+            dest += 16;
+            source += 16;
+            bytes -= 16;
+        }
+    }
+#endif
+    memcpy(dest, source, bytes);
+}
+
+#ifdef PIXELKERNELS_SSE2
+// Premultiplies two pixels held as 16 bit lanes (b, g, r, a, b, g, r, a)..
+static inline __m128i PremultiplyLanes(__m128i px)
+{
+    const auto alphaLane = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    const auto alphaOne  = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    const auto bias      = _mm_set1_epi16(128);
+
+    // Broadcast alpha to every channel, but scale the alpha channel itself by 255 so it survives the divide..
+    auto alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    alpha      = _mm_or_si128(_mm_andnot_si128(alphaLane, alpha), alphaOne);
+
+    // (c * a + 127) / 255, exact for every c and a..
+    auto t = _mm_add_epi16(_mm_mullo_epi16(px, alpha), bias);
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+#endif
+
+static void PremultiplyRow(uint8_t* dest, const uint8_t* source, int32_t width)
+{
+    auto src = (const uint32_t*)source;
+    auto dst = (uint32_t*)dest;
+    auto x   = 0;
+#ifdef PIXELKERNELS_SSE2
+    const auto zero = _mm_setzero_si128();
+    for (; x + 4 <= width; x += 4)
+    {
+        auto px = _mm_loadu_si128((const __m128i*)(src + x));
+        auto lo = PremultiplyLanes(_mm_unpacklo_epi8(px, zero));
+        auto hi = PremultiplyLanes(_mm_unpackhi_epi8(px, zero));
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; x < width; x++)
+    {
+        dst[x] = PremultiplyPixel(src[x]);
+    }
+}
+
+static void AlphaRow(uint8_t* dest, const uint8_t* source, int32_t width)
+{
+    auto x = 0;
+#ifdef PIXELKERNELS_SSE2
+    for (; x + 16 <= width; x += 16)
+    {
+        auto a = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(source + (x * 4))), 24);
+        auto b = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(source + (x * 4) + 16)), 24);
+        auto c = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(source + (x * 4) + 32)), 24);
+        auto d = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(source + (x * 4) + 48)), 24);
+        auto packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128((__m128i*)(dest + x), packed);
+    }
+#endif
+    auto src = (const uint32_t*)source;
+    for (; x < width; x++)
+    {
+        dest[x] = (uint8_t)(src[x] >> 24);
+    }
+}
+
+#ifdef PIXELKERNELS_SSE2
+// Quantizes two pixels held as 16 bit lanes and returns their packed 16 bit values in the low two dwords..
+static inline __m128i QuantizeLanes(__m128i px, __m128i scale, __m128i bias, __m128i weight)
+{
+    auto x     = _mm_add_epi16(_mm_mullo_epi16(px, scale), bias);
+    auto level = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+    auto sums  = _mm_madd_epi16(level, weight);
+    sums       = _mm_add_epi32(sums, _mm_srli_epi64(sums, 32));
+    return _mm_shuffle_epi32(sums, _MM_SHUFFLE(3, 1, 2, 0));
+}
+#endif
+
+static void QuantizeRow(uint8_t* dest, const uint8_t* source, int32_t width, int32_t y, const QuantizeFormat_t& format, bool dither)
+{
+    auto src = (const uint32_t*)source;
+    auto dst = (uint16_t*)dest;
+    auto row = g_Bayer[y & 3];
+    auto x   = 0;
+#ifdef PIXELKERNELS_SSE2
+    const auto zero   = _mm_setzero_si128();
+    const auto scale  = _mm_set_epi16(format.Scale[3], format.Scale[2], format.Scale[1], format.Scale[0], format.Scale[3], format.Scale[2], format.Scale[1], format.Scale[0]);
+    const auto weight = _mm_set_epi16(format.Weight[3], format.Weight[2], format.Weight[1], format.Weight[0], format.Weight[3], format.Weight[2], format.Weight[1], format.Weight[0]);
+    const auto ab     = (int16_t)format.AlphaBias;
+    int16_t d[4];
+    for (auto i = 0; i < 4; i++)
+    {
+        d[i] = dither ? (int16_t)row[i] : (int16_t)127;
+    }
+    const auto biasLo = _mm_set_epi16(ab, d[1], d[1], d[1], ab, d[0], d[0], d[0]);
+    const auto biasHi = _mm_set_epi16(ab, d[3], d[3], d[3], ab, d[2], d[2], d[2]);
+
+    for (; x + 4 <= width; x += 4)
+    {
+        auto px = _mm_loadu_si128((const __m128i*)(src + x));
+        auto lo = QuantizeLanes(_mm_unpacklo_epi8(px, zero), scale, biasLo, weight);
+        auto hi = QuantizeLanes(_mm_unpackhi_epi8(px, zero), scale, biasHi, weight);
+
+        // Keep the low 16 bits of each packed value and narrow to words..
+        auto packed = _mm_unpacklo_epi64(lo, hi);
+        packed      = _mm_srai_epi32(_mm_slli_epi32(packed, 16), 16);
+        _mm_storel_epi64((__m128i*)(dst + x), _mm_packs_epi32(packed, packed));
+    }
+#endif
+    for (; x < width; x++)
+    {
+        dst[x] = QuantizePixel(src[x], format, dither ? row[x & 3] : 127);
+    }
+}
+
+int32_t GetBytesPerPixel(BlitFormat format)
+{
+    switch (format)
+    {
+        case BlitFormat::A8:
+            return 1;
+        case BlitFormat::A4R4G4B4:
+        case BlitFormat::A1R5G5B5:
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+void BlitPixels(uint8_t* dest, int32_t destPitch, const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height, BlitFormat format, uint32_t flags, bool streaming)
+{
+    auto premultiply   = (flags & BlitFlagPremultiply) != 0;
+    auto dither        = (flags & BlitFlagDither) != 0;
+    auto bytesPerPixel = GetBytesPerPixel(format);
+
+    // Plain copies go straight to the destination..
+    if ((format == BlitFormat::A8R8G8B8) && !premultiply)
+    {
+        for (auto y = 0; y < height; y++)
+        {
+            CopyRow(dest, source, width * 4, streaming);
+            dest += destPitch;
+            source += sourcePitch;
+        }
+    }
+
+    // Everything else is converted in spans through small buffers, so each pixel is read once and can still be streamed..
+    else
+    {
+        const int32_t spanWidth = 1024;
+        alignas(16) uint8_t premultiplied[spanWidth * 4];
+        alignas(16) uint8_t converted[spanWidth * 4];
+
+        for (auto y = 0; y < height; y++)
+        {
+            for (auto x = 0; x < width; x += spanWidth)
+            {
+                auto span   = ((width - x) < spanWidth) ? (width - x) : spanWidth;
+                auto input  = source + (x * 4);
+                auto output = dest + (x * bytesPerPixel);
+                auto target = streaming ? converted : output;
+
+                if (premultiply && (format != BlitFormat::A8))
+                {
+                    auto premultiplyTarget = (format == BlitFormat::A8R8G8B8) ? target : premultiplied;
+                    PremultiplyRow(premultiplyTarget, input, span);
+                    input = premultiplyTarget;
+                }
+
+                switch (format)
+                {
+                    case BlitFormat::A8:
+                        AlphaRow(target, input, span);
+                        break;
+                    case BlitFormat::A4R4G4B4:
+                        QuantizeRow(target, input, span, y, g_A4R4G4B4, dither);
+                        break;
+                    case BlitFormat::A1R5G5B5:
+                        QuantizeRow(target, input, span, y, g_A1R5G5B5, dither);
+                        break;
+                    default:
+                        break;
+                }
+
+                if (streaming)
+                    CopyRow(output, converted, span * bytesPerPixel, true);
+            }
+            dest += destPitch;
+            source += sourcePitch;
+        }
+    }
+
+#ifdef PIXELKERNELS_SSE2
+    if (streaming)
+        _mm_sfence();
+#endif
+}
+
+#ifdef PIXELKERNELS_SSE2
+static inline __m128 LoadPixelPs(const uint8_t* px)
+{
+    const auto zero = _mm_setzero_si128();
+    auto bytes      = _mm_cvtsi32_si128(*(const int32_t*)px);
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero));
+}
+
+static inline __m128 WeightedSquare(__m128 px)
+{
+    return _mm_mul_ps(_mm_mul_ps(px, px), _mm_shuffle_ps(px, px, _MM_SHUFFLE(3, 3, 3, 3)));
+}
+#endif
+
+void DownsamplePixels(uint8_t* dest, int32_t destPitch, const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height)
+{
+    auto destWidth  = (width > 1) ? (width / 2) : 1;
+    auto destHeight = (height > 1) ? (height / 2) : 1;
+
+#ifdef PIXELKERNELS_SSE2
+    const auto alphaLane = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+    const auto quarter   = _mm_set1_ps(0.25f);
+    const auto half      = _mm_set1_ps(0.5f);
+#endif
+    for (auto y = 0; y < destHeight; y++)
+    {
+        auto row0 = source + ((y * 2) * sourcePitch);
+        auto row1 = ((y * 2 + 1) < height) ? (row0 + sourcePitch) : row0;
+        auto out  = (uint32_t*)(dest + (y * destPitch));
+        for (auto x = 0; x < destWidth; x++)
+        {
+            auto x0 = (x * 2) * 4;
+            auto x1 = ((x * 2 + 1) < width) ? (x0 + 4) : x0;
+#ifdef PIXELKERNELS_SSE2
+            // Lanes are (b, g, r, a), accumulate c^2 * a and a across the 2x2 footprint..
+            auto p00   = LoadPixelPs(row0 + x0);
+            auto p01   = LoadPixelPs(row0 + x1);
+            auto p10   = LoadPixelPs(row1 + x0);
+            auto p11   = LoadPixelPs(row1 + x1);
+            auto color = _mm_add_ps(_mm_add_ps(WeightedSquare(p00), WeightedSquare(p01)), _mm_add_ps(WeightedSquare(p10), WeightedSquare(p11)));
+            auto alpha = _mm_add_ps(_mm_add_ps(p00, p01), _mm_add_ps(p10, p11));
+            alpha      = _mm_shuffle_ps(alpha, alpha, _MM_SHUFFLE(3, 3, 3, 3));
+            if (_mm_cvtss_f32(alpha) == 0.0f)
+            {
+                out[x] = 0;
+                continue;
+            }
+
+            color       = _mm_sqrt_ps(_mm_div_ps(color, alpha));
+            color       = _mm_or_ps(_mm_andnot_ps(alphaLane, color), _mm_and_ps(alphaLane, _mm_mul_ps(alpha, quarter)));
+            auto packed = _mm_cvttps_epi32(_mm_add_ps(color, half));
+            packed      = _mm_packs_epi32(packed, packed);
+            out[x]      = (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(packed, packed));
+#else
+            const uint8_t* px[4] = {row0 + x0, row0 + x1, row1 + x0, row1 + x1};
+            float alpha          = 0.0f;
+            float color[3]       = {0.0f, 0.0f, 0.0f};
+            for (auto i = 0; i < 4; i++)
+            {
+                float a = px[i][3];
+                alpha += a;
+                for (auto c = 0; c < 3; c++)
+                    color[c] += (float)px[i][c] * (float)px[i][c] * a;
+            }
+            if (alpha == 0.0f)
+            {
+                out[x] = 0;
+                continue;
+            }
+
+            uint32_t result = (uint32_t)(alpha * 0.25f + 0.5f) << 24;
+            for (auto c = 0; c < 3; c++)
+                result |= (uint32_t)(sqrtf(color[c] / alpha) + 0.5f) << (c * 8);
+            out[x] = result;
+#endif
+        }
+    }
+}
+
+MipChain::MipChain(const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height)
+    : m_Buffer(nullptr)
+    , m_LevelBytes(0)
+    , m_Pixels(source)
+    , m_Pitch(sourcePitch)
+    , m_Width(width)
+    , m_Height(height)
+{
+}
+
+MipChain::~MipChain()
+{
+    free(m_Buffer);
+}
+
+bool MipChain::Next()
+{
+    // Every level after the first fits in the space of the first..
+    auto nextWidth  = (m_Width > 1) ? (m_Width / 2) : 1;
+    auto nextHeight = (m_Height > 1) ? (m_Height / 2) : 1;
+    if (!m_Buffer)
+    {
+        m_LevelBytes = (size_t)nextWidth * nextHeight * 4;
+        m_Buffer     = (uint8_t*)malloc(m_LevelBytes * 2);
+        if (!m_Buffer)
+            return false;
+    }
+
+    auto target = (m_Pixels == m_Buffer) ? (m_Buffer + m_LevelBytes) : m_Buffer;
+    DownsamplePixels(target, nextWidth * 4, m_Pixels, m_Pitch, m_Width, m_Height);
+    m_Pixels = target;
+    m_Pitch  = nextWidth * 4;
+    m_Width  = nextWidth;
+    m_Height = nextHeight;
+    return true;
+}
+
+
+// Each token starts with a 16 bit header, the high bit marks a run followed by one pixel, otherwise the low bits count
+// the literal pixels that follow. Tokens never cross rows..
+static const uint32_t RleRunFlag  = 0x8000;
+static const uint32_t RleMaxCount = 0x7FFF;
+
+void EncodeRle(const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height, std::vector<uint8_t>* pOutput)
+{
+    for (auto y = 0; y < height; y++)
+    {
+        auto row = (const uint32_t*)(source + (y * sourcePitch));
+        auto x   = 0;
+        while (x < width)
+        {
+            uint32_t count = 1;
+            while (((x + count) < (uint32_t)width) && (count < RleMaxCount) && (row[x + count] == row[x]))
+                count++;
+
+            // Runs shorter than three pixels are cheaper as part of a literal..
+            if (count < 3)
+            {
+                auto start = x;
+                while ((x < width) && ((uint32_t)(x - start) < RleMaxCount))
+                {
+                    if (((x + 2) < width) && (row[x] == row[x + 1]) && (row[x] == row[x + 2]))
+                        break;
+                    x++;
+                }
+                count       = x - start;
+                auto header = (uint16_t)count;
+                auto offset = pOutput->size();
+                pOutput->resize(offset + 2 + (count * 4));
+                memcpy(pOutput->data() + offset, &header, 2);
+                memcpy(pOutput->data() + offset + 2, row + start, count * 4);
+                continue;
+            }
+
+            auto header = (uint16_t)(RleRunFlag | count);
+            auto offset = pOutput->size();
+            pOutput->resize(offset + 6);
+            memcpy(pOutput->data() + offset, &header, 2);
+            memcpy(pOutput->data() + offset + 2, row + x, 4);
+            x += count;
+        }
+    }
+}
+
+void DecodeRle(uint8_t* dest, int32_t destPitch, int32_t width, int32_t height, const uint8_t* rle)
+{
+    for (auto y = 0; y < height; y++)
+    {
+        auto row = (uint32_t*)(dest + (y * destPitch));
+        auto x   = 0;
+        while (x < width)
+        {
+            uint16_t header;
+            memcpy(&header, rle, 2);
+            rle += 2;
+
+            auto count = header & RleMaxCount;
+            if (header & RleRunFlag)
+            {
+                uint32_t pixel;
+                memcpy(&pixel, rle, 4);
+                rle += 4;
+                for (uint32_t i = 0; i < count; i++)
+                    row[x + i] = pixel;
+            }
+            else
+            {
+                memcpy(row + x, rle, count * 4);
+                rle += count * 4;
+            }
+            x += count;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef __PixelKernels_H_INCLUDED__
+#define __PixelKernels_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Destination formats BlitPixels can produce from A8R8G8B8 canvas pixels.
+enum class BlitFormat : uint32_t
+{
+    A8R8G8B8,
+    A8,
+    A4R4G4B4,
+    A1R5G5B5,
+};
+
+enum BlitFlags : uint32_t
+{
+    BlitFlagNone        = 0,
+    BlitFlagPremultiply = 1, // Multiply color channels by alpha before storing.
+    BlitFlagDither      = 2, // Ordered dithering when reducing to 16 bit formats.
+};
+
+// Copies below this many bytes go through the cache, larger ones use non-temporal stores.
+constexpr uint32_t StreamingThreshold = 256 * 1024;
+
+int32_t GetBytesPerPixel(BlitFormat format);
+
+// Copies a width x height block of A8R8G8B8 pixels between two pitched buffers, converting each pixel on the way.
+// When streaming is set, the destination is written with non-temporal stores (use for write-combined memory).
+void BlitPixels(uint8_t* dest, int32_t destPitch, const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height, BlitFormat format, uint32_t flags, bool streaming);
+
+// Halves a width x height block of A8R8G8B8 pixels into max(1, width / 2) x max(1, height / 2) with a 2x2 box filter.
+// Colors are averaged weighted by alpha in approximately linear light (gamma 2), so transparent texels never bleed into edges.
+void DownsamplePixels(uint8_t* dest, int32_t destPitch, const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height);
+
+// Walks the mip chain below a block of A8R8G8B8 pixels, each level filtered from the previous one with DownsamplePixels.
+// Levels ping-pong between two halves of one scratch buffer sized for the first level below the source.
+class MipChain
+{
+private:
+    uint8_t* m_Buffer;
+    size_t m_LevelBytes;
+    const uint8_t* m_Pixels;
+    int32_t m_Pitch;
+    int32_t m_Width;
+    int32_t m_Height;
+
+public:
+    MipChain(const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height);
+    ~MipChain();
+    MipChain(const MipChain&)            = delete;
+    MipChain& operator=(const MipChain&) = delete;
+
+    // Moves to the next level, false if the scratch buffer could not be allocated..
+    bool Next();
+    const uint8_t* GetPixels() const { return m_Pixels; }
+    int32_t GetPitch() const { return m_Pitch; }
+    int32_t GetWidth() const { return m_Width; }
+    int32_t GetHeight() const { return m_Height; }
+};
+
+// Run length encodes a width x height block of A8R8G8B8 pixels, appending to pOutput. Rendered text is mostly runs
+// of transparent or solid pixels, so this is a compact way to keep a cpu copy of a texture.
+void EncodeRle(const uint8_t* source, int32_t sourcePitch, int32_t width, int32_t height, std::vector<uint8_t>* pOutput);
+void DecodeRle(uint8_t* dest, int32_t destPitch, int32_t width, int32_t height, const uint8_t* rle);
+#endif
@@ -0,0 +1,67 @@
+#include "RasterCache.h"
+#include <string.h>
+
+RasterCache::RasterCache(size_t capacity)
+    : m_Bytes(0)
+    , m_Capacity(capacity)
+{}
+
+bool RasterCache::Contains(uint64_t key)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Index.find(key) != m_Index.end();
+}
+
+void RasterCache::Insert(uint64_t key, int32_t width, int32_t height, const uint8_t* pixels, int32_t pitch)
+{
+    auto rowBytes = (size_t)width * 4;
+    auto bytes    = rowBytes * height;
+    if (bytes > m_Capacity)
+        return;
+
+    // Copy outside the lock, workers insert while the render thread looks up..
+    Entry_t entry;
+    entry.Key    = key;
+    entry.Width  = width;
+    entry.Height = height;
+    auto copy    = std::make_shared<std::vector<uint8_t>>(bytes);
+    for (auto y = 0; y < height; y++)
+        memcpy(copy->data() + (y * rowBytes), pixels + (y * pitch), rowBytes);
+    entry.Pixels = std::move(copy);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto iter = m_Index.find(key);
+    if (iter != m_Index.end())
+    {
+        m_Bytes -= iter->second->Pixels->size();
+        m_Entries.erase(iter->second);
+        m_Index.erase(iter);
+    }
+    Evict(m_Capacity - bytes);
+    m_Entries.push_front(std::move(entry));
+    m_Index[key] = m_Entries.begin();
+    m_Bytes += bytes;
+}
+
+void RasterCache::Trim(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Evict(capacity);
+}
+
+size_t RasterCache::GetBytes()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Bytes;
+}
+
+void RasterCache::Evict(size_t capacity)
+{
+    while ((m_Bytes > capacity) && !m_Entries.empty())
+    {
+        auto& last = m_Entries.back();
+        m_Bytes -= last.Pixels->size();
+        m_Index.erase(last.Key);
+        m_Entries.pop_back();
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef __RasterCache_H_INCLUDED__
+#define __RasterCache_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+// Thread safe, byte bounded LRU cache of trimmed A8R8G8B8 bitmaps keyed by request hash.
+class RasterCache
+{
+private:
+    struct Entry_t
+    {
+        uint64_t Key;
+        int32_t Width;
+        int32_t Height;
+        std::shared_ptr<const std::vector<uint8_t>> Pixels; // Shared so a lookup can outlive eviction.
+    };
+
+    std::mutex m_Mutex;
+    std::list<Entry_t> m_Entries; // Most recently used first.
+    std::unordered_map<uint64_t, std::list<Entry_t>::iterator> m_Index;
+    size_t m_Bytes;
+    size_t m_Capacity;
+
+public:
+    RasterCache(size_t capacity);
+    bool Contains(uint64_t key);
+    void Insert(uint64_t key, int32_t width, int32_t height, const uint8_t* pixels, int32_t pitch);
+    void Trim(size_t capacity);
+    size_t GetBytes();
+
+    // Calls use(pixels, pitch, width, height) if the key is present. The cache is not locked during the call,
+    // so use may insert or trim.
+    template <typename F>
+    bool Find(uint64_t key, F&& use)
+    {
+        std::shared_ptr<const std::vector<uint8_t>> pixels;
+        int32_t width;
+        int32_t height;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            auto iter = m_Index.find(key);
+            if (iter == m_Index.end())
+                return false;
+
+            m_Entries.splice(m_Entries.begin(), m_Entries, iter->second);
+            auto& entry = *iter->second;
+            pixels      = entry.Pixels;
+            width       = entry.Width;
+            height      = entry.Height;
+        }
+        use(pixels->data(), width * 4, width, height);
+        return true;
+    }
+
+private:
+    void Evict(size_t capacity);
+};
+#endif
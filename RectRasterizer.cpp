@@ -0,0 +1,177 @@
+#include "RectRasterizer.h"
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define RECTRASTERIZER_SSE2
+#endif
+
+// Everything that does not change per pixel..
+struct RectSetup_t
+{
+    float CenterX;
+    float CenterY;
+    float InnerX; // Half extents minus the radius.
+    float InnerY;
+    float Radius;
+    float HalfOutline;
+    float Fill[4]; // Blue, green, red in 0..255, alpha in 0..1.
+    float Outline[4];
+};
+
+static void UnpackColor(uint32_t color, float* pOut)
+{
+    pOut[0] = (float)(color & 0xFF);
+    pOut[1] = (float)((color >> 8) & 0xFF);
+    pOut[2] = (float)((color >> 16) & 0xFF);
+    pOut[3] = (float)(color >> 24) / 255.0f;
+}
+
+static inline float Saturate(float x)
+{
+    return (x < 0.0f) ? 0.0f : ((x > 1.0f) ? 1.0f : x);
+}
+
+static uint32_t ShadePixel(const RectSetup_t& setup, float x, float y, const uint32_t* pFill)
+{
+    // Signed distance to the rounded rect, negative inside..
+    auto qx       = fabsf(x - setup.CenterX) - setup.InnerX;
+    auto qy       = fabsf(y - setup.CenterY) - setup.InnerY;
+    auto ox       = (qx > 0.0f) ? qx : 0.0f;
+    auto oy       = (qy > 0.0f) ? qy : 0.0f;
+    auto inside   = (qx > qy) ? qx : qy;
+    auto distance = sqrtf(ox * ox + oy * oy) + ((inside < 0.0f) ? inside : 0.0f) - setup.Radius;
+
+    // Box filtered coverage across the edge, the outline is the band between two offset edges..
+    auto fillCoverage    = Saturate(0.5f - distance);
+    auto outlineCoverage = Saturate(0.5f + setup.HalfOutline - distance) - Saturate(0.5f - setup.HalfOutline - distance);
+
+    // Per pixel fill color from the ramp, if there is one..
+    float fill[4];
+    if (pFill)
+        UnpackColor(*pFill, fill);
+    else
+        memcpy(fill, setup.Fill, sizeof(fill));
+
+    auto fillAlpha    = fill[3] * fillCoverage;
+    auto outlineAlpha = setup.Outline[3] * outlineCoverage;
+    auto under        = fillAlpha * (1.0f - outlineAlpha);
+    auto alpha        = outlineAlpha + under;
+    if (alpha <= 0.0f)
+        return 0;
+
+    uint32_t result = (uint32_t)(alpha * 255.0f + 0.5f) << 24;
+    for (auto c = 0; c < 3; c++)
+    {
+        result |= (uint32_t)((setup.Outline[c] * outlineAlpha + fill[c] * under) / alpha + 0.5f) << (c * 8);
+    }
+    return result;
+}
+
+void RasterizeRoundedRect(uint8_t* dest, int32_t destPitch, int32_t width, int32_t height, const RoundedRect_t& rect)
+{
+    RectSetup_t setup;
+    auto halfWidth    = (rect.Right - rect.Left) * 0.5f;
+    auto halfHeight   = (rect.Bottom - rect.Top) * 0.5f;
+    halfWidth         = (halfWidth > 0.0f) ? halfWidth : 0.0f;
+    halfHeight        = (halfHeight > 0.0f) ? halfHeight : 0.0f;
+    auto radius       = (rect.Radius < halfWidth) ? rect.Radius : halfWidth;
+    radius            = (radius < halfHeight) ? radius : halfHeight;
+    radius            = (radius > 0.0f) ? radius : 0.0f;
+    setup.CenterX     = (rect.Left + rect.Right) * 0.5f;
+    setup.CenterY     = (rect.Top + rect.Bottom) * 0.5f;
+    setup.InnerX      = halfWidth - radius;
+    setup.InnerY      = halfHeight - radius;
+    setup.Radius      = radius;
+    setup.HalfOutline = rect.OutlineWidth * 0.5f;
+
+    UnpackColor(rect.FillColor, setup.Fill);
+    UnpackColor(rect.OutlineColor, setup.Outline);
+
+    // Ramp colors are looked up a row at a time..
+    std::vector<int32_t> indices(rect.FillRamp ? width : 0);
+    std::vector<uint32_t> fills(rect.FillRamp ? width : 0);
+
+#ifdef RECTRASTERIZER_SSE2
+    const auto zero        = _mm_setzero_ps();
+    const auto one         = _mm_set1_ps(1.0f);
+    const auto half        = _mm_set1_ps(0.5f);
+    const auto absMask     = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const auto centerX     = _mm_set1_ps(setup.CenterX);
+    const auto innerX      = _mm_set1_ps(setup.InnerX);
+    const auto radiusLanes = _mm_set1_ps(setup.Radius);
+    const auto outerBand   = _mm_set1_ps(0.5f + setup.HalfOutline);
+    const auto innerBand   = _mm_set1_ps(0.5f - setup.HalfOutline);
+    const auto byteMask    = _mm_set1_epi32(0xFF);
+    const auto outlineA    = _mm_set1_ps(setup.Outline[3]);
+    const auto scale       = _mm_set1_ps(255.0f);
+#endif
+
+    for (auto y = 0; y < height; y++)
+    {
+        auto out = (uint32_t*)(dest + (y * destPitch));
+        auto py  = (float)y + 0.5f;
+        auto x   = 0;
+        if (rect.FillRamp)
+        {
+            GetGradientIndices(rect.FillShape, 0, y, width, indices.data());
+            for (auto i = 0; i < width; i++)
+                fills[i] = rect.FillRamp[indices[i]];
+        }
+
+#ifdef RECTRASTERIZER_SSE2
+        // Per row terms are scalar, four pixels of the row are shaded at once..
+        auto qy         = fabsf(py - setup.CenterY) - setup.InnerY;
+        auto qyLanes    = _mm_set1_ps(qy);
+        auto oySquared  = _mm_set1_ps((qy > 0.0f) ? (qy * qy) : 0.0f);
+        auto px         = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const auto step = _mm_set1_ps(4.0f);
+        for (; (x + 4) <= width; x += 4, px = _mm_add_ps(px, step))
+        {
+            auto qx       = _mm_sub_ps(_mm_and_ps(_mm_sub_ps(px, centerX), absMask), innerX);
+            auto ox       = _mm_max_ps(qx, zero);
+            auto inside   = _mm_min_ps(_mm_max_ps(qx, qyLanes), zero);
+            auto distance = _mm_sub_ps(_mm_add_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(ox, ox), oySquared)), inside), radiusLanes);
+
+            auto fillCoverage    = _mm_min_ps(_mm_max_ps(_mm_sub_ps(half, distance), zero), one);
+            auto outlineCoverage = _mm_sub_ps(_mm_min_ps(_mm_max_ps(_mm_sub_ps(outerBand, distance), zero), one),
+                                              _mm_min_ps(_mm_max_ps(_mm_sub_ps(innerBand, distance), zero), one));
+
+            __m128 fill[4];
+            if (rect.FillRamp)
+            {
+                auto colors = _mm_loadu_si128((const __m128i*)(fills.data() + x));
+                for (auto c = 0; c < 3; c++)
+                    fill[c] = _mm_cvtepi32_ps(_mm_and_si128(_mm_srl_epi32(colors, _mm_cvtsi32_si128(c * 8)), byteMask));
+                fill[3] = _mm_div_ps(_mm_cvtepi32_ps(_mm_srli_epi32(colors, 24)), scale);
+            }
+            else
+            {
+                for (auto c = 0; c < 4; c++)
+                    fill[c] = _mm_set1_ps(setup.Fill[c]);
+            }
+
+            auto fillAlpha    = _mm_mul_ps(fill[3], fillCoverage);
+            auto outlineAlpha = _mm_mul_ps(outlineA, outlineCoverage);
+            auto under        = _mm_mul_ps(fillAlpha, _mm_sub_ps(one, outlineAlpha));
+            auto alpha        = _mm_add_ps(outlineAlpha, under);
+            auto visible      = _mm_cmpgt_ps(alpha, zero);
+            auto inverse      = _mm_and_ps(_mm_div_ps(one, _mm_max_ps(alpha, _mm_set1_ps(1e-20f))), visible);
+
+            auto packed = _mm_slli_epi32(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(alpha, scale), half)), 24);
+            for (auto c = 0; c < 3; c++)
+            {
+                auto color   = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(setup.Outline[c]), outlineAlpha), _mm_mul_ps(fill[c], under));
+                auto channel = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(color, inverse), half));
+                packed       = _mm_or_si128(packed, _mm_sll_epi32(channel, _mm_cvtsi32_si128(c * 8)));
+            }
+            _mm_storeu_si128((__m128i*)(out + x), _mm_and_si128(packed, _mm_castps_si128(visible)));
+        }
+#endif
+
+        for (; x < width; x++)
+            out[x] = ShadePixel(setup, (float)x + 0.5f, py, rect.FillRamp ? &fills[x] : nullptr);
+    }
+}
\ No newline at end of file
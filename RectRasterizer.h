@@ -0,0 +1,30 @@
+#ifndef __RectRasterizer_H_INCLUDED__
+#define __RectRasterizer_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "Gradient.h"
+#include <stdint.h>
+
+// Rounded rectangle in pixel coordinates, pixel centers sit at +0.5 like gdiplus with PixelOffsetModeHighQuality.
+// The outline is centered on the edge, the fill is FillColor or, when FillRamp is set, the ramp laid out along FillShape.
+struct RoundedRect_t
+{
+    float Left;
+    float Top;
+    float Right;
+    float Bottom;
+    float Radius;
+    float OutlineWidth;
+    uint32_t OutlineColor;
+    uint32_t FillColor;
+    const uint32_t* FillRamp; // GradientLutSize entries.
+    GradientShape_t FillShape;
+};
+
+// Writes width x height non-premultiplied A8R8G8B8 pixels of the rectangle, outline composited over fill.
+// Coverage is computed analytically from the signed distance to the edge, so the whole image is one pass.
+void RasterizeRoundedRect(uint8_t* dest, int32_t destPitch, int32_t width, int32_t height, const RoundedRect_t& rect);
+#endif
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "StagingRing.h"
+
+// Smallest class is 64 pixels on a side, tiny uploads share it instead of creating their own textures..
+static const uint32_t MinimumClassShift = 6;
+
+// Enough for both slots of a 1024x1024 A8R8G8B8 class with mipmaps, larger classes make do with one slot..
+static const uint64_t DefaultLimit = 12 * 1024 * 1024;
+
+std::mutex StagingRing::s_Mutex;
+std::map<IDirect3DDevice8*, StagingRing*> StagingRing::s_Rings;
+
+static uint32_t GetClassShift(uint32_t size)
+{
+    uint32_t shift = MinimumClassShift;
+    while ((1u << shift) < size)
+        shift++;
+    return shift;
+}
+
+StagingRing::StagingRing(IDirect3DDevice8* pDevice, uint32_t slotCount, uint64_t limit)
+    : m_Device(pDevice)
+    , m_Users(0)
+    , m_SlotCount(slotCount)
+    , m_Limit(limit)
+    , m_Bytes(0)
+    , m_Clock(0)
+{}
+
+StagingRing::~StagingRing()
+{
+    Trim(0);
+}
+
+StagingRing* StagingRing::Attach(IDirect3DDevice8* pDevice)
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    auto& pRing = s_Rings[pDevice];
+    if (!pRing)
+        pRing = new StagingRing(pDevice, 2, DefaultLimit);
+    pRing->m_Users++;
+    return pRing;
+}
+
+void StagingRing::Detach()
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    if (--m_Users != 0)
+        return;
+    s_Rings.erase(m_Device);
+    delete this;
+}
+
+// Releases the slots of the class used longest ago, other than the one at keep..
+bool StagingRing::EvictOldest(uint64_t keep)
+{
+    auto oldest = m_Classes.end();
+    for (auto iter = m_Classes.begin(); iter != m_Classes.end(); iter++)
+    {
+        if ((iter->first != keep) && ((oldest == m_Classes.end()) || (iter->second.LastUse < oldest->second.LastUse)))
+            oldest = iter;
+    }
+    if (oldest == m_Classes.end())
+        return false;
+
+    for (auto pTexture : oldest->second.Slots)
+        pTexture->Release();
+    m_Bytes -= (uint64_t)oldest->second.Bytes * oldest->second.Slots.size();
+    m_Classes.erase(oldest);
+    return true;
+}
+
+IDirect3DTexture8* StagingRing::Acquire(D3DFORMAT format, uint32_t width, uint32_t height, uint32_t levels)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto widthShift   = GetClassShift(width);
+    auto heightShift  = GetClassShift(height);
+    auto key          = ((uint64_t)format << 16) | (widthShift << 8) | heightShift;
+    auto& sizeClass   = m_Classes[key];
+    sizeClass.LastUse = ++m_Clock;
+
+    // Slots are created on first use up to the slot count while they fit the limit, then reused round robin..
+    auto grow = sizeClass.Slots.empty() || ((sizeClass.Slots.size() < m_SlotCount) && ((m_Bytes + sizeClass.Bytes) <= m_Limit));
+    if (grow)
+    {
+        // Full mip chain, so the same slot serves textures with or without mipmaps..
+        IDirect3DTexture8* pTexture;
+        if (FAILED(m_Device->CreateTexture(1u << widthShift, 1u << heightShift, 0, 0, format, D3DPOOL_SYSTEMMEM, &pTexture)))
+        {
+            if (sizeClass.Slots.empty())
+                m_Classes.erase(key);
+            return nullptr;
+        }
+
+        uint32_t bytes = 0;
+        D3DSURFACE_DESC desc;
+        for (DWORD level = 0; level < pTexture->GetLevelCount(); level++)
+        {
+            if (SUCCEEDED(pTexture->GetLevelDesc(level, &desc)))
+                bytes += desc.Size;
+        }
+        sizeClass.Bytes = bytes;
+        sizeClass.Slots.push_back(pTexture);
+        m_Bytes += bytes;
+
+        // Make room by dropping other classes, the one in use always keeps its slot..
+        while ((m_Bytes > m_Limit) && EvictOldest(key))
+            ;
+        return (pTexture->GetLevelCount() >= levels) ? pTexture : nullptr;
+    }
+
+    auto pTexture  = sizeClass.Slots[sizeClass.Next % sizeClass.Slots.size()];
+    sizeClass.Next = (sizeClass.Next + 1) % sizeClass.Slots.size();
+    return (pTexture->GetLevelCount() >= levels) ? pTexture : nullptr;
+}
+
+// Drops the least recently used classes until no more than bytes are left, zero releases everything..
+void StagingRing::Trim(uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    while ((m_Bytes > bytes) && EvictOldest(UINT64_MAX))
+        ;
+}
\ No newline at end of file
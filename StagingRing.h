@@ -0,0 +1,52 @@
+#ifndef __StagingRing_H_INCLUDED__
+#define __StagingRing_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "Defines.h"
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Reusable D3DPOOL_SYSTEMMEM textures used to upload into D3DPOOL_DEFAULT, bucketed by format and power of two size.
+// Consecutive uploads of one size class rotate through its slots, so the cpu rarely writes into a texture the driver
+// may still be copying from. One ring is shared by every manager on a device and it stays under a byte limit by
+// dropping the size class used longest ago, a class only grows past one slot while that fits.
+class StagingRing
+{
+private:
+    struct Class_t
+    {
+        std::vector<IDirect3DTexture8*> Slots;
+        uint32_t Next;
+        uint32_t Bytes; // Per slot.
+        uint64_t LastUse;
+    };
+
+    std::mutex m_Mutex;
+    IDirect3DDevice8* m_Device;
+    uint32_t m_Users;
+    uint32_t m_SlotCount;
+    uint64_t m_Limit;
+    std::map<uint64_t, Class_t> m_Classes;
+    uint64_t m_Bytes;
+    uint64_t m_Clock;
+
+    static std::mutex s_Mutex;
+    static std::map<IDirect3DDevice8*, StagingRing*> s_Rings;
+
+    StagingRing(IDirect3DDevice8* pDevice, uint32_t slotCount, uint64_t limit);
+    ~StagingRing();
+    bool EvictOldest(uint64_t keep);
+
+public:
+    // The ring for a device, created by the first manager to attach and freed when the last one detaches..
+    static StagingRing* Attach(IDirect3DDevice8* pDevice);
+    void Detach();
+    IDirect3DTexture8* Acquire(D3DFORMAT format, uint32_t width, uint32_t height, uint32_t levels);
+    void Trim(uint64_t bytes);
+    uint64_t GetBytes() const { return m_Bytes; }
+};
+#endif
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "TextBlock.h"
+#include "GdiFontManager.h"
+
+TextBlock::TextBlock(GdiFontManager* pManager, const GdiTextDesc_t& style, uint32_t capacity, bool markup)
+    : m_Manager(pManager)
+    , m_Style(style)
+    , m_Gradient{}
+    , m_Markup(markup)
+    , m_Lines((capacity == 0) ? 1 : capacity)
+    , m_Head(0)
+    , m_Count(0)
+    , m_Bottom(0)
+{
+    // Keep our own copy of the gradient, the caller's may not outlive the block..
+    if (style.Gradient)
+    {
+        m_Gradient       = *style.Gradient;
+        m_Style.Gradient = &m_Gradient;
+    }
+    m_Style.Font.FontText       = nullptr;
+    m_Style.Font.FontTextLength = 0;
+
+    // Every line takes at least one line of the font, rounded up so lines land on whole pixels..
+    auto spacing  = pManager->GetLineSpacing(style.Font.FontFamilyId, style.Font.FontFlags, style.Font.FontHeight);
+    m_LineSpacing = (int32_t)ceil(spacing);
+    if (m_LineSpacing < 1)
+        m_LineSpacing = 1;
+}
+
+TextBlock::~TextBlock()
+{
+    Clear();
+}
+
+bool TextBlock::RenderLine(Line_t* pLine)
+{
+    auto desc                = m_Style;
+    desc.Font.FontText       = pLine->Text.data();
+    desc.Font.FontTextLength = (uint32_t)pLine->Text.size();
+    pLine->Texture           = m_Markup ? m_Manager->CreateMarkupTexture(desc) : m_Manager->CreateTextTexture(desc);
+    return pLine->Texture.Texture != nullptr;
+}
+
+void TextBlock::ReleaseLine(Line_t* pLine)
+{
+    if (pLine->Texture.Texture && !pLine->Lost)
+        pLine->Texture.Texture->Release();
+    pLine->Lost    = false;
+    pLine->Texture = GdiFontReturnEx_t();
+    pLine->Text.clear();
+}
+
+// Renders only the new line. Lines that draw nothing, such as empty ones, still take up a line of space..
+bool TextBlock::Append(const char* text, uint32_t length)
+{
+    if (m_Count == m_Lines.size())
+    {
+        ReleaseLine(&GetLine(0));
+        m_Head = (m_Head + 1) % m_Lines.size();
+        m_Count--;
+    }
+
+    auto& line = GetLine(m_Count);
+    line.Lost  = false;
+    line.Text.assign(text, length);
+    auto drawn = (length == 0) || RenderLine(&line);
+
+    // A line that wrapped or holds line breaks covers as many lines as its height rounds to..
+    auto rows = (line.Texture.Height + (m_LineSpacing / 2)) / m_LineSpacing;
+    line.Top     = m_Bottom;
+    line.Advance = ((rows < 1) ? 1 : rows) * m_LineSpacing;
+    m_Bottom    += line.Advance;
+    m_Count++;
+    return drawn;
+}
+
+void TextBlock::Clear()
+{
+    for (uint32_t i = 0; i < m_Count; i++)
+        ReleaseLine(&GetLine(i));
+    m_Head   = 0;
+    m_Count  = 0;
+    m_Bottom = 0;
+}
+
+// Keeps the newest lines that still fit..
+void TextBlock::SetCapacity(uint32_t capacity)
+{
+    if (capacity == 0)
+        capacity = 1;
+    while (m_Count > capacity)
+    {
+        ReleaseLine(&GetLine(0));
+        m_Head = (m_Head + 1) % m_Lines.size();
+        m_Count--;
+    }
+
+    std::vector<Line_t> lines(capacity);
+    for (uint32_t i = 0; i < m_Count; i++)
+        lines[i] = std::move(GetLine(i));
+    m_Lines = std::move(lines);
+    m_Head  = 0;
+}
+
+// Copies out lines starting at first, counting from the oldest. Textures are borrowed and stay valid until
+// the line is dropped from the block..
+uint32_t TextBlock::GetLines(uint32_t first, GdiTextLine_t* pLines, uint32_t count) const
+{
+    if (first >= m_Count)
+        return 0;
+    if (count > (m_Count - first))
+        count = m_Count - first;
+
+    auto origin = GetLine(0).Top;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        auto& line        = GetLine(first + i);
+        pLines[i].Texture = line.Lost ? nullptr : line.Texture.Texture;
+        pLines[i].Format  = line.Texture.Format;
+        pLines[i].Width   = line.Texture.Width;
+        pLines[i].Height  = line.Texture.Height;
+        pLines[i].Top     = (int32_t)(line.Top - origin);
+        pLines[i].Advance = line.Advance;
+    }
+    return count;
+}
+
+int32_t TextBlock::GetHeight() const
+{
+    if (m_Count == 0)
+        return 0;
+    return (int32_t)(m_Bottom - GetLine(0).Top);
+}
+
+// Lets go of textures in D3DPOOL_DEFAULT so the device can be reset..
+void TextBlock::OnDeviceLost()
+{
+    for (uint32_t i = 0; i < m_Count; i++)
+    {
+        auto& line = GetLine(i);
+        if (!line.Texture.Texture || line.Lost)
+            continue;
+
+        D3DSURFACE_DESC surface;
+        if (FAILED(line.Texture.Texture->GetLevelDesc(0, &surface)) || (surface.Pool != D3DPOOL_DEFAULT))
+            continue;
+        line.Texture.Texture->Release();
+        line.Lost = true;
+    }
+}
+
+// Claims the textures rebuilt by the manager, lines it couldn't rebuild are rendered again..
+void TextBlock::OnDeviceReset()
+{
+    for (uint32_t i = 0; i < m_Count; i++)
+    {
+        auto& line = GetLine(i);
+        if (!line.Lost)
+            continue;
+
+        line.Lost            = false;
+        line.Texture.Texture = m_Manager->GetRestoredTexture(line.Texture.Handle);
+        if (!line.Texture.Texture)
+            RenderLine(&line);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef __TextBlock_H_INCLUDED__
+#define __TextBlock_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "Defines.h"
+#include <string>
+#include <vector>
+
+class GdiFontManager;
+
+// Multi-line text kept as one texture per line in a ring, for chat and log windows that only ever append.
+// Appending renders the new line alone and, once the ring is full, drops the oldest. Lines are stacked on a
+// fixed pitch so placing them never needs anything but the running offset. Blocks are owned by the manager
+// that created them, which hands them its device loss and reset.
+class TextBlock
+{
+private:
+    struct Line_t
+    {
+        GdiFontReturnEx_t Texture; // Holds one reference.
+        std::string Text;         // Kept to render the line again if its texture can't be restored.
+        uint64_t Top;             // Offset from the first line ever appended.
+        int32_t Advance;
+        bool Lost; // Texture was released with the device, its handle claims the replacement.
+    };
+
+    GdiFontManager* m_Manager;
+    GdiTextDesc_t m_Style;
+    GdiGradient_t m_Gradient;
+    bool m_Markup;
+    int32_t m_LineSpacing;
+    std::vector<Line_t> m_Lines;
+    uint32_t m_Head; // Oldest line.
+    uint32_t m_Count;
+    uint64_t m_Bottom; // Offset just past the newest line.
+
+    Line_t& GetLine(uint32_t index) { return m_Lines[(m_Head + index) % m_Lines.size()]; }
+    const Line_t& GetLine(uint32_t index) const { return m_Lines[(m_Head + index) % m_Lines.size()]; }
+    bool RenderLine(Line_t* pLine);
+    void ReleaseLine(Line_t* pLine);
+
+public:
+    TextBlock(GdiFontManager* pManager, const GdiTextDesc_t& style, uint32_t capacity, bool markup);
+    ~TextBlock();
+    bool Append(const char* text, uint32_t length);
+    void Clear();
+    void SetCapacity(uint32_t capacity);
+    uint32_t GetLines(uint32_t first, GdiTextLine_t* pLines, uint32_t count) const;
+    uint32_t GetCount() const { return m_Count; }
+    int32_t GetHeight() const;
+    void OnDeviceLost();
+    void OnDeviceReset();
+};
+#endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "TextPanel.h"
+#include "GdiFontManager.h"
+#include "Hash.h"
+
+TextPanel::TextPanel(GdiFontManager* pManager, const GdiFontDesc_t& style, IDirect3DTexture8* pTexture, int32_t width, int32_t pitch, uint32_t lineCount)
+    : m_Manager(pManager)
+    , m_Style(style)
+    , m_Texture(pTexture)
+    , m_Format(D3DFMT_UNKNOWN)
+    , m_Width(width)
+    , m_Pitch(pitch)
+    , m_Slots(lineCount, Slot_t{ HashSeed, 0, 0 })
+{
+    m_Style.FontText       = nullptr;
+    m_Style.FontTextLength = 0;
+
+    D3DSURFACE_DESC surfaceDesc;
+    if (SUCCEEDED(pTexture->GetLevelDesc(0, &surfaceDesc)))
+        m_Format = surfaceDesc.Format;
+}
+
+TextPanel::~TextPanel()
+{
+    m_Texture->Release();
+}
+
+// Splits text on line breaks and writes the lines that differ from what their slot holds, lines past the
+// last slot are dropped. The returned texture is borrowed from the panel and its size covers the pixels
+// written so far, kept per slot so nothing has to be read back to trim it..
+GdiFontReturnEx_t TextPanel::Update(const char* text, uint32_t length, uint32_t* pRedrawn)
+{
+    // Slots written before the blit settings changed are written again..
+    uint32_t redrawn = 0;
+    uint32_t start   = 0;
+    auto seed        = m_Manager->HashPanelSettings(HashSeed);
+    for (uint32_t slot = 0; slot < m_Slots.size(); slot++)
+    {
+        auto end = start;
+        while ((end < length) && (text[end] != '\n'))
+            end++;
+        auto lineLength = (start < length) ? (end - start) : 0;
+        if ((lineLength != 0) && (text[start + lineLength - 1] == '\r'))
+            lineLength--;
+
+        auto& entry = m_Slots[slot];
+        auto hash   = HashBytes(text + start, lineLength, seed);
+        if (hash != entry.Hash)
+        {
+            // A slot that failed to draw keeps its old hash so the next update tries again..
+            if (m_Manager->DrawPanelLine(m_Texture, m_Style, text + start, lineLength, (int32_t)slot * m_Pitch, m_Width, m_Pitch, &entry.Width, &entry.Height))
+                entry.Hash = hash;
+            redrawn++;
+        }
+        start = (end < length) ? (end + 1) : length;
+    }
+
+    GdiFontReturnEx_t ret;
+    for (uint32_t slot = 0; slot < m_Slots.size(); slot++)
+    {
+        auto& entry = m_Slots[slot];
+        if (entry.Width > ret.Width)
+            ret.Width = entry.Width;
+        if (entry.Height > 0)
+            ret.Height = ((int32_t)slot * m_Pitch) + entry.Height;
+    }
+    ret.Texture = m_Texture;
+    ret.Format  = m_Format;
+    if (pRedrawn)
+        *pRedrawn = redrawn;
+    return ret;
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef __TextPanel_H_INCLUDED__
+#define __TextPanel_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "Defines.h"
+#include <vector>
+
+class GdiFontManager;
+
+// Mixed into raster cache keys for panel lines, which are cached with their left margin instead of trimmed.
+constexpr uint64_t PanelLineSalt = 0x9E3779B97F4A7C15ull;
+
+// Multi-line text composed into a single texture that is updated in place, for tooltips and stat panels where
+// a few lines change between updates. Every line owns a slot one line pitch tall, and only the slots whose
+// text changed are rendered and written again. The texture is D3DPOOL_MANAGED so slots can be locked on their
+// own, which also means it survives a device reset.
+class TextPanel
+{
+private:
+    struct Slot_t
+    {
+        uint64_t Hash; // Of the text last written to the slot and the blit settings it was written with.
+        int32_t Width;  // Extent of the pixels written, measured from the left edge.
+        int32_t Height; // Measured from the top of the slot.
+    };
+
+    GdiFontManager* m_Manager;
+    GdiFontDesc_t m_Style;
+    IDirect3DTexture8* m_Texture; // Holds one reference.
+    D3DFORMAT m_Format;
+    int32_t m_Width;
+    int32_t m_Pitch;
+    std::vector<Slot_t> m_Slots;
+
+public:
+    TextPanel(GdiFontManager* pManager, const GdiFontDesc_t& style, IDirect3DTexture8* pTexture, int32_t width, int32_t pitch, uint32_t lineCount);
+    ~TextPanel();
+    GdiFontReturnEx_t Update(const char* text, uint32_t length, uint32_t* pRedrawn);
+};
+#endif
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "TextureTracker.h"
+
+TextureTracker::TextureTracker()
+    : m_Cursor(0)
+    , m_NextHandle(0)
+    , m_VideoBytes(0)
+    , m_ShadowBytes(0)
+{}
+
+TextureTracker::~TextureTracker()
+{
+    for (auto& entry : m_Entries)
+    {
+        if (entry.Texture)
+            entry.Texture->Release();
+    }
+}
+
+uint32_t TextureTracker::Track(IDirect3DTexture8* pTexture, D3DPOOL pool, int32_t width, int32_t height, std::vector<uint8_t>&& backup)
+{
+    // Sum the driver reported size of every level, the managed pool keeps a system memory copy of each..
+    uint32_t bytes = 0;
+    D3DSURFACE_DESC desc;
+    for (DWORD level = 0; level < pTexture->GetLevelCount(); level++)
+    {
+        if (SUCCEEDED(pTexture->GetLevelDesc(level, &desc)))
+            bytes += desc.Size;
+    }
+    pTexture->GetLevelDesc(0, &desc);
+
+    // Handles only matter for textures that can be lost, zero is never handed out..
+    if (++m_NextHandle == 0)
+        m_NextHandle = 1;
+
+    Entry_t entry;
+    entry.Texture     = pTexture;
+    entry.Handle      = (pool == D3DPOOL_DEFAULT) ? m_NextHandle : 0;
+    entry.Holders     = 1;
+    entry.Unclaimed   = 0;
+    entry.Pool        = pool;
+    entry.Format      = desc.Format;
+    entry.Width       = width;
+    entry.Height      = height;
+    entry.Levels      = pTexture->GetLevelCount();
+    entry.VideoBytes  = bytes;
+    entry.ShadowBytes = (pool == D3DPOOL_MANAGED) ? bytes : (uint32_t)backup.size();
+    entry.Backup      = std::move(backup);
+    pTexture->AddRef();
+    m_VideoBytes += entry.VideoBytes;
+    m_ShadowBytes += entry.ShadowBytes;
+    m_Entries.push_back(std::move(entry));
+    return m_Entries.back().Handle;
+}
+
+void TextureTracker::Sweep(size_t maxCount)
+{
+    // Visit entries round robin so frequent partial sweeps still cover everything over time..
+    for (size_t visited = 0; (visited < maxCount) && !m_Entries.empty(); visited++)
+    {
+        if (m_Cursor >= m_Entries.size())
+            m_Cursor = 0;
+
+        // Lost textures and restored ones the caller has not claimed yet are kept..
+        auto& entry = m_Entries[m_Cursor];
+        if (!entry.Texture || (entry.Unclaimed != 0))
+        {
+            m_Cursor++;
+            continue;
+        }
+
+        // Release returns the remaining count, so a balanced AddRef/Release reads it without changing it..
+        entry.Texture->AddRef();
+        if (entry.Texture->Release() > 1)
+        {
+            m_Cursor++;
+            continue;
+        }
+
+        entry.Texture->Release();
+        m_VideoBytes -= entry.VideoBytes;
+        m_ShadowBytes -= entry.ShadowBytes;
+        if (m_Cursor != (m_Entries.size() - 1))
+            entry = std::move(m_Entries.back());
+        m_Entries.pop_back();
+    }
+}
+
+void TextureTracker::ReleaseDefaultPool()
+{
+    // The caller has to release its own references too before the device can be reset..
+    for (size_t i = 0; i < m_Entries.size();)
+    {
+        auto& entry = m_Entries[i];
+        if ((entry.Pool != D3DPOOL_DEFAULT) || !entry.Texture)
+        {
+            i++;
+            continue;
+        }
+
+        entry.Texture->Release();
+        entry.Texture = nullptr;
+        m_VideoBytes -= entry.VideoBytes;
+
+        // Holders that never claimed the texture rebuilt after the last reset will not claim this one either..
+        entry.Holders  -= entry.Unclaimed;
+        entry.Unclaimed = 0;
+        if (entry.Holders == 0)
+        {
+            m_ShadowBytes -= entry.ShadowBytes;
+            if (i != (m_Entries.size() - 1))
+                entry = std::move(m_Entries.back());
+            m_Entries.pop_back();
+            continue;
+        }
+        i++;
+    }
+    m_Cursor = 0;
+}
+
+// Another caller was given the handle of a texture that is already tracked..
+void TextureTracker::Share(uint32_t handle)
+{
+    if (handle == 0)
+        return;
+
+    for (auto& entry : m_Entries)
+    {
+        if (entry.Handle == handle)
+        {
+            entry.Holders++;
+            return;
+        }
+    }
+}
+
+IDirect3DTexture8* TextureTracker::Claim(uint32_t handle)
+{
+    if (handle == 0)
+        return nullptr;
+
+    for (auto& entry : m_Entries)
+    {
+        if (entry.Texture && (entry.Unclaimed != 0) && (entry.Handle == handle))
+        {
+            entry.Unclaimed--;
+            entry.Texture->AddRef();
+            return entry.Texture;
+        }
+    }
+    return nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef __TextureTracker_H_INCLUDED__
+#define __TextureTracker_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "Defines.h"
+#include <vector>
+
+// Keeps a reference to every texture handed out so its memory can be accounted for.
+// A texture is released once the caller has dropped all of its own references.
+// Textures in D3DPOOL_DEFAULT carry a run length encoded copy of their pixels so they can be rebuilt after a reset.
+// The caller claims a rebuilt texture by the handle it was given, since the old pointer may already belong to another
+// texture. A shared texture counts every caller given its handle and each one can claim it once. Holders that did not
+// claim are forgotten when the device is lost again, and the texture with them if nobody claimed it.
+class TextureTracker
+{
+private:
+    struct Entry_t
+    {
+        IDirect3DTexture8* Texture; // Null while the device is lost.
+        uint32_t Handle;
+        uint32_t Holders;   // Callers given the handle.
+        uint32_t Unclaimed; // Holders the texture rebuilt after the last reset has not been handed back to.
+        D3DPOOL Pool;
+        D3DFORMAT Format;
+        int32_t Width;
+        int32_t Height;
+        uint32_t Levels;
+        uint32_t VideoBytes;
+        uint32_t ShadowBytes;
+        std::vector<uint8_t> Backup;
+    };
+
+    std::vector<Entry_t> m_Entries;
+    size_t m_Cursor;
+    uint32_t m_NextHandle;
+    uint64_t m_VideoBytes;
+    uint64_t m_ShadowBytes;
+
+public:
+    TextureTracker();
+    ~TextureTracker();
+    uint32_t Track(IDirect3DTexture8* pTexture, D3DPOOL pool, int32_t width, int32_t height, std::vector<uint8_t>&& backup);
+    void Sweep(size_t maxCount);
+    void ReleaseDefaultPool();
+    void Share(uint32_t handle);
+    IDirect3DTexture8* Claim(uint32_t handle);
+    uint32_t GetCount() const { return (uint32_t)m_Entries.size(); }
+    uint64_t GetVideoBytes() const { return m_VideoBytes; }
+    uint64_t GetShadowBytes() const { return m_ShadowBytes; }
+
+    // Calls create(backup, width, height, format, levels) for every texture lost with the device, which returns the
+    // replacement or null if it could not be rebuilt.
+    template <typename F>
+    void Restore(F&& create)
+    {
+        for (size_t i = 0; i < m_Entries.size();)
+        {
+            auto& entry = m_Entries[i];
+            if (entry.Texture)
+            {
+                i++;
+                continue;
+            }
+
+            entry.Texture   = create(entry.Backup.data(), entry.Width, entry.Height, entry.Format, entry.Levels);
+            entry.Unclaimed = entry.Holders;
+            if (!entry.Texture)
+            {
+                m_ShadowBytes -= entry.ShadowBytes;
+                if (i != (m_Entries.size() - 1))
+                    entry = std::move(m_Entries.back());
+                m_Entries.pop_back();
+                continue;
+            }
+            m_VideoBytes += entry.VideoBytes;
+            i++;
+        }
+        m_Cursor = 0;
+    }
+};
+#endif
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "Utf8.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define UTF8_SSE2
+#endif
+
+// Decodes one multi-byte sequence starting at source[0] (which is >= 0x80) and returns the bytes consumed..
+static inline uint32_t DecodeSequence(const uint8_t* source, const uint8_t* end, uint32_t* codePoint)
+{
+    auto lead = source[0];
+    uint32_t needed;
+    uint8_t low = 0x80, high = 0xBF;
+    if ((lead >= 0xC2) && (lead <= 0xDF))
+    {
+        needed     = 1;
+        *codePoint = lead & 0x1F;
+    }
+    else if ((lead >= 0xE0) && (lead <= 0xEF))
+    {
+        needed     = 2;
+        *codePoint = lead & 0x0F;
+        if (lead == 0xE0)
+            low = 0xA0; // Overlong..
+        else if (lead == 0xED)
+            high = 0x9F; // Surrogates..
+    }
+    else if ((lead >= 0xF0) && (lead <= 0xF4))
+    {
+        needed     = 3;
+        *codePoint = lead & 0x07;
+        if (lead == 0xF0)
+            low = 0x90; // Overlong..
+        else if (lead == 0xF4)
+            high = 0x8F; // Past U+10FFFF..
+    }
+    else
+    {
+        *codePoint = 0xFFFD;
+        return 1;
+    }
+
+    // Only the first continuation byte has a narrowed range, a bad byte ends the maximal subpart..
+    for (uint32_t i = 1; i <= needed; i++)
+    {
+        if ((source + i) >= end)
+        {
+            *codePoint = 0xFFFD;
+            return i;
+        }
+        auto c = source[i];
+        if ((c < low) || (c > high))
+        {
+            *codePoint = 0xFFFD;
+            return i;
+        }
+        *codePoint = (*codePoint << 6) | (c & 0x3F);
+        low        = 0x80;
+        high       = 0xBF;
+    }
+    return needed + 1;
+}
+
+uint32_t Utf8ToUtf16(const char* source, uint32_t length, uint16_t* dest)
+{
+    auto src   = (const uint8_t*)source;
+    auto end   = src + length;
+    auto start = dest;
+
+    while (src < end)
+    {
+#ifdef UTF8_SSE2
+        // Widen runs of ascii 32 bytes at a time..
+        const auto zero = _mm_setzero_si128();
+        while ((end - src) >= 32)
+        {
+            auto a = _mm_loadu_si128((const __m128i*)src);
+            auto b = _mm_loadu_si128((const __m128i*)(src + 16));
+            if (_mm_movemask_epi8(_mm_or_si128(a, b)) != 0)
+                break;
+            _mm_storeu_si128((__m128i*)(dest), _mm_unpacklo_epi8(a, zero));
+            _mm_storeu_si128((__m128i*)(dest + 8), _mm_unpackhi_epi8(a, zero));
+            _mm_storeu_si128((__m128i*)(dest + 16), _mm_unpacklo_epi8(b, zero));
+            _mm_storeu_si128((__m128i*)(dest + 24), _mm_unpackhi_epi8(b, zero));
+            src += 32;
+            dest += 32;
+        }
+        if ((end - src) >= 16)
+        {
+            auto a = _mm_loadu_si128((const __m128i*)src);
+            if (_mm_movemask_epi8(a) == 0)
+            {
+                _mm_storeu_si128((__m128i*)(dest), _mm_unpacklo_epi8(a, zero));
+                _mm_storeu_si128((__m128i*)(dest + 8), _mm_unpackhi_epi8(a, zero));
+                src += 16;
+                dest += 16;
+                continue;
+            }
+        }
+#endif
+        if (src >= end)
+            break;
+
+        // Short ascii runs and tails..
+        if (*src < 0x80)
+        {
+            *dest++ = *src++;
+            continue;
+        }
+
+        uint32_t codePoint;
+        src += DecodeSequence(src, end, &codePoint);
+        if (codePoint >= 0x10000)
+        {
+            codePoint -= 0x10000;
+            *dest++ = (uint16_t)(0xD800 | (codePoint >> 10));
+            *dest++ = (uint16_t)(0xDC00 | (codePoint & 0x3FF));
+        }
+        else
+        {
+            *dest++ = (uint16_t)codePoint;
+        }
+    }
+
+    return (uint32_t)(dest - start);
+}
@@ -0,0 +1,14 @@
+#ifndef __Utf8_H_INCLUDED__
+#define __Utf8_H_INCLUDED__
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include <stdint.h>
+
+// Converts UTF-8 to UTF-16 and returns the number of code units written.
+// The output never needs more than length code units. Ill-formed sequences become U+FFFD, one per maximal subpart,
+// matching MultiByteToWideChar(CP_UTF8) without MB_ERR_INVALID_CHARS.
+uint32_t Utf8ToUtf16(const char* source, uint32_t length, uint16_t* dest);
+#endif
@@ -0,0 +1,188 @@
+#include "MaskBlur.h"
+#include "TestCommon.h"
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+// A solid square in the middle of an empty mask, widths that are not a multiple of 16 reach the scalar columns..
+static std::vector<uint8_t> MakeSquare(int32_t width, int32_t height, int32_t side)
+{
+    std::vector<uint8_t> mask((size_t)width * height, 0);
+    auto left = (width - side) / 2;
+    auto top  = (height - side) / 2;
+    for (auto y = top; y < (top + side); y++)
+    {
+        for (auto x = left; x < (left + side); x++)
+            mask[(y * width) + x] = 255;
+    }
+    return mask;
+}
+
+// Variance of the coverage along x, a blur adds its own variance to it..
+static double GetVarianceX(const std::vector<uint8_t>& mask, int32_t width, int32_t height)
+{
+    double total = 0.0;
+    double mean  = 0.0;
+    for (auto y = 0; y < height; y++)
+    {
+        for (auto x = 0; x < width; x++)
+        {
+            total += mask[(y * width) + x];
+            mean  += (double)x * mask[(y * width) + x];
+        }
+    }
+    mean /= total;
+
+    double variance = 0.0;
+    for (auto y = 0; y < height; y++)
+    {
+        for (auto x = 0; x < width; x++)
+            variance += ((double)x - mean) * ((double)x - mean) * mask[(y * width) + x];
+    }
+    return variance / total;
+}
+
+// Every radius above zero spreads the square by a gaussian of half its sigma, within a few percent..
+static void CheckVariance(float radius)
+{
+    const int32_t width  = 157;
+    const int32_t height = 141;
+    auto mask    = MakeSquare(width, height, 41);
+    auto before  = GetVarianceX(mask, width, height);
+    std::vector<uint8_t> scratch(mask.size());
+    BlurMask(mask.data(), scratch.data(), width, height, radius);
+
+    auto sigma    = radius * 0.5;
+    auto added    = GetVarianceX(mask, width, height) - before;
+    auto expected = sigma * sigma;
+    CHECK(fabs(added - expected) <= (0.02 + (0.05 * expected)), "radius %.2f added a variance of %.4f, expected %.4f", radius, added, expected);
+
+    // Nothing reaches further than the extent..
+    auto extent = GetBlurExtent(radius);
+    auto left   = ((width - 41) / 2) - extent - 1;
+    for (auto y = 0; y < height; y++)
+        CHECK(mask[(y * width) + left] == 0, "radius %.2f reached column %d, extent is %d", radius, left, extent);
+}
+
+// Separable convolution with the given 1d kernel, pixels outside the mask count as empty..
+static std::vector<double> Convolve(const std::vector<double>& mask, int32_t width, int32_t height, const std::vector<double>& kernel)
+{
+    auto reach = (int32_t)(kernel.size() / 2);
+    std::vector<double> rows((size_t)width * height, 0.0);
+    for (auto y = 0; y < height; y++)
+    {
+        for (auto x = 0; x < width; x++)
+        {
+            for (auto i = -reach; i <= reach; i++)
+            {
+                if (((x + i) >= 0) && ((x + i) < width))
+                    rows[(y * width) + x] += kernel[i + reach] * mask[(y * width) + x + i];
+            }
+        }
+    }
+
+    std::vector<double> result((size_t)width * height, 0.0);
+    for (auto y = 0; y < height; y++)
+    {
+        for (auto x = 0; x < width; x++)
+        {
+            for (auto i = -reach; i <= reach; i++)
+            {
+                if (((y + i) >= 0) && ((y + i) < height))
+                    result[(y * width) + x] += kernel[i + reach] * rows[((y + i) * width) + x];
+            }
+        }
+    }
+    return result;
+}
+
+// The box BlurMask should apply in each pass, found from the extent and the variance it has to add..
+static std::vector<double> GetBoxKernel(float radius)
+{
+    auto reach    = GetBlurExtent(radius) / 3;
+    auto variance = (radius * 0.5) * (radius * 0.5) / 3.0;
+    auto box      = reach - 1;
+    auto edge     = (variance - (box * (box + 1)) / 3.0) * (2 * box + 1) / (2.0 * (reach * reach) - 2.0 * variance);
+    if ((box * (box + 1)) / 3.0 >= variance)
+    {
+        box  = reach;
+        edge = 0.0;
+    }
+
+    std::vector<double> kernel((reach * 2) + 1, 0.0);
+    for (auto i = -box; i <= box; i++)
+        kernel[i + reach] = 1.0;
+    if (edge > 0.0)
+        kernel[0] = kernel[reach * 2] = edge;
+    auto total = (2 * box + 1) + (2.0 * edge);
+    for (auto& weight : kernel)
+        weight /= total;
+    return kernel;
+}
+
+// Matches a direct convolution with the same boxes up to the rounding of each pass, and stays close to
+// the gaussian it stands in for..
+static void CheckAgainstReference(float radius)
+{
+    const int32_t width  = 83;
+    const int32_t height = 67;
+    std::vector<uint8_t> mask((size_t)width * height);
+    srand(3);
+    for (auto& value : mask)
+        value = ((rand() % 4) == 0) ? 255 : 0;
+    std::vector<uint8_t> blurred = mask;
+    std::vector<uint8_t> scratch(mask.size());
+    BlurMask(blurred.data(), scratch.data(), width, height, radius);
+
+    auto sigma = radius * 0.5;
+    auto reach = (int32_t)ceil(sigma * 4.0) + 1;
+    std::vector<double> gaussian((reach * 2) + 1);
+    double gaussianSum = 0.0;
+    for (auto i = -reach; i <= reach; i++)
+        gaussianSum += gaussian[i + reach] = exp(-(double)(i * i) / (2.0 * sigma * sigma));
+    for (auto& weight : gaussian)
+        weight /= gaussianSum;
+
+    // Each pass drops whatever it spreads past the border, so the boxes are applied one at a time..
+    std::vector<double> source(mask.begin(), mask.end());
+    auto box      = GetBoxKernel(radius);
+    auto boxes    = Convolve(Convolve(Convolve(source, width, height, box), width, height, box), width, height, box);
+    auto expected = Convolve(source, width, height, gaussian);
+    double boxError = 0.0;
+    double sumError = 0.0;
+    for (size_t i = 0; i < mask.size(); i++)
+    {
+        boxError  = fmax(boxError, fabs(boxes[i] - (double)blurred[i]));
+        sumError += fabs(expected[i] - (double)blurred[i]);
+    }
+    auto meanError = sumError / (double)mask.size();
+    printf("radius %.2f: max %.2f from the boxes, mean %.2f from a gaussian\n", radius, boxError, meanError);
+    CHECK(boxError <= 3.0, "radius %.2f is %.2f off the box reference", radius, boxError);
+    CHECK(meanError <= 4.0, "radius %.2f mean error %.2f against a gaussian", radius, meanError);
+}
+
+int main()
+{
+    // Zero leaves the mask alone..
+    auto mask     = MakeSquare(37, 29, 9);
+    auto original = mask;
+    std::vector<uint8_t> scratch(mask.size());
+    BlurMask(mask.data(), scratch.data(), 37, 29, 0.0f);
+    CHECK(mask == original, "radius 0 changed the mask");
+    CHECK(GetBlurExtent(0.0f) == 0, "radius 0 has an extent of %d", GetBlurExtent(0.0f));
+
+    // Small radii used to round down to empty boxes and leave a hard edge..
+    for (auto radius : { 0.5f, 1.0f, 1.5f, 2.0f })
+    {
+        mask = original;
+        BlurMask(mask.data(), scratch.data(), 37, 29, radius);
+        CHECK(mask != original, "radius %.1f left the mask untouched", radius);
+        CHECK(GetBlurExtent(radius) > 0, "radius %.1f has no extent", radius);
+    }
+
+    for (auto radius : { 0.25f, 0.5f, 1.0f, 1.5f, 2.0f, 2.5f, 3.0f, 4.5f, 8.0f, 13.0f, 24.0f })
+        CheckVariance(radius);
+    for (auto radius : { 1.0f, 2.0f, 3.0f, 6.0f, 12.0f })
+        CheckAgainstReference(radius);
+    return TestResult();
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef __D3DStub_H_INCLUDED__
+#define __D3DStub_H_INCLUDED__
+
+// Stands in for Defines.h so the texture bookkeeping builds without d3d8, force included ahead of the sources..
+#define __GdiFontTxDefines__
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned long DWORD;
+typedef long HRESULT;
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+
+enum D3DFORMAT
+{
+    D3DFMT_UNKNOWN  = 0,
+    D3DFMT_A8R8G8B8 = 21,
+};
+
+enum D3DPOOL
+{
+    D3DPOOL_DEFAULT   = 0,
+    D3DPOOL_MANAGED   = 1,
+    D3DPOOL_SYSTEMMEM = 2,
+};
+
+struct D3DSURFACE_DESC
+{
+    D3DFORMAT Format;
+    D3DPOOL Pool;
+    uint32_t Size;
+    uint32_t Width;
+    uint32_t Height;
+};
+
+// Counts references like COM and deletes itself on the last release, s_Alive catches leaks..
+struct IDirect3DTexture8
+{
+    static inline int32_t s_Alive = 0;
+    uint32_t m_Refs;
+    uint32_t m_Width;
+    uint32_t m_Height;
+    D3DPOOL m_Pool;
+
+    IDirect3DTexture8(uint32_t width, uint32_t height, D3DPOOL pool)
+        : m_Refs(1)
+        , m_Width(width)
+        , m_Height(height)
+        , m_Pool(pool)
+    {
+        s_Alive++;
+    }
+    uint32_t AddRef() { return ++m_Refs; }
+    uint32_t Release()
+    {
+        auto refs = --m_Refs;
+        if (refs == 0)
+        {
+            s_Alive--;
+            delete this;
+        }
+        return refs;
+    }
+    DWORD GetLevelCount() { return 1; }
+    HRESULT GetLevelDesc(DWORD level, D3DSURFACE_DESC* pDesc)
+    {
+        if (level != 0)
+            return -1;
+        pDesc->Format = D3DFMT_A8R8G8B8;
+        pDesc->Pool   = m_Pool;
+        pDesc->Size   = m_Width * m_Height * 4;
+        pDesc->Width  = m_Width;
+        pDesc->Height = m_Height;
+        return 0;
+    }
+};
+#endif
\ No newline at end of file
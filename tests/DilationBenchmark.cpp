@@ -0,0 +1,82 @@
+#include "MaskDilation.h"
+#include "TestCommon.h"
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+// Scattered discs and single pixels, a stand-in for glyph shapes with both wide and thin parts..
+static std::vector<uint8_t> MakeMask(int32_t width, int32_t height, uint32_t seed)
+{
+    std::vector<uint8_t> mask((size_t)width * height, 0);
+    srand(seed);
+    auto shapes = (width * height) / 400;
+    for (auto i = 0; i < shapes; i++)
+    {
+        auto cx     = rand() % width;
+        auto cy     = rand() % height;
+        auto radius = rand() % 6;
+        for (auto y = cy - radius; y <= cy + radius; y++)
+        {
+            for (auto x = cx - radius; x <= cx + radius; x++)
+            {
+                if ((x >= 0) && (y >= 0) && (x < width) && (y < height) && (((x - cx) * (x - cx) + (y - cy) * (y - cy)) <= radius * radius))
+                    mask[(y * width) + x] = 255;
+            }
+        }
+    }
+    return mask;
+}
+
+// Solid masks put the edge half a pixel past the nearest covered center, so brute force over every covered
+// pixel gives the expected coverage..
+static void CheckAgainstReference(int32_t width, int32_t height, float radius)
+{
+    auto mask = MakeMask(width, height, 7);
+    std::vector<uint8_t> dest((size_t)width * height);
+    std::vector<int16_t> scratch((size_t)width * height * 2);
+    DilateMask(dest.data(), width, mask.data(), width, width, height, radius, scratch.data());
+
+    for (auto y = 0; y < height; y++)
+    {
+        for (auto x = 0; x < width; x++)
+        {
+            auto nearest = 1e20f;
+            for (auto sy = 0; sy < height; sy++)
+            {
+                for (auto sx = 0; sx < width; sx++)
+                {
+                    if (mask[(sy * width) + sx] != 0)
+                        nearest = fminf(nearest, sqrtf((float)((x - sx) * (x - sx) + (y - sy) * (y - sy))));
+                }
+            }
+            auto coverage = fminf(fmaxf(radius + 1.0f - nearest, 0.0f), 1.0f);
+            auto expected = (int32_t)(coverage * 255.0f + 0.5f);
+            auto actual   = (int32_t)dest[(y * width) + x];
+            CHECK(abs(expected - actual) <= 1, "radius %.1f pixel %d,%d is %d, expected %d", radius, x, y, actual, expected);
+        }
+    }
+}
+
+int main()
+{
+    for (auto width = 1; width <= 8; width++)
+        CheckAgainstReference(61, 37, width * 0.5f);
+
+    // Outline widths 1 to 8 over a full canvas, the scratch is reused the way the leased canvas keeps it..
+    const int32_t width  = 2048;
+    const int32_t height = 1024;
+    auto mask = MakeMask(width, height, 1);
+    std::vector<uint8_t> dest((size_t)width * height);
+    std::vector<int16_t> scratch((size_t)width * height * 2);
+    for (auto outline = 1; outline <= 8; outline++)
+    {
+        const int32_t iterations = 5;
+        auto start = std::chrono::steady_clock::now();
+        for (auto i = 0; i < iterations; i++)
+            DilateMask(dest.data(), width, mask.data(), width, width, height, outline * 0.5f, scratch.data());
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+        printf("Dilate %dx%d outline %d: %.2f ms, %.1f Mpixel/s\n", width, height, outline, seconds * 1000.0, ((double)width * height) / seconds / 1e6);
+    }
+    return TestResult();
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "PixelKernels.h"
+#include "TestCommon.h"
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+// Checks every output texel against the alpha weighted gamma 2 average of its 2x2 footprint..
+static void CheckAgainstReference(const std::vector<uint32_t>& source, int32_t width, int32_t height)
+{
+    auto destWidth  = width / 2;
+    auto destHeight = height / 2;
+    std::vector<uint32_t> dest((size_t)destWidth * destHeight);
+    DownsamplePixels((uint8_t*)dest.data(), destWidth * 4, (const uint8_t*)source.data(), width * 4, width, height);
+
+    for (auto y = 0; y < destHeight; y++)
+    {
+        for (auto x = 0; x < destWidth; x++)
+        {
+            double alpha    = 0.0;
+            double color[3] = {0.0, 0.0, 0.0};
+            for (auto dy = 0; dy < 2; dy++)
+            {
+                for (auto dx = 0; dx < 2; dx++)
+                {
+                    auto px = source[((2 * y + dy) * width) + (2 * x) + dx];
+                    auto a  = (double)(px >> 24);
+                    alpha  += a;
+                    for (auto c = 0; c < 3; c++)
+                    {
+                        auto v    = (double)((px >> (8 * c)) & 0xFF);
+                        color[c] += v * v * a;
+                    }
+                }
+            }
+
+            auto px = dest[(y * destWidth) + x];
+            if (alpha == 0.0)
+            {
+                CHECK(px == 0, "texel %d,%d is %08X over a transparent footprint", x, y, px);
+                continue;
+            }
+            CHECK((int32_t)(px >> 24) == (int32_t)((alpha / 4.0) + 0.5), "texel %d,%d alpha %u, expected %.2f", x, y, px >> 24, alpha / 4.0);
+            for (auto c = 0; c < 3; c++)
+            {
+                auto expected = (int32_t)(sqrt(color[c] / alpha) + 0.5);
+                auto actual   = (int32_t)((px >> (8 * c)) & 0xFF);
+                CHECK(abs(expected - actual) <= 1, "texel %d,%d channel %d is %d, expected %d", x, y, c, actual, expected);
+            }
+        }
+    }
+}
+
+static void Benchmark(const std::vector<uint32_t>& source, int32_t width, int32_t height)
+{
+    auto destWidth = width / 2;
+    std::vector<uint32_t> dest((size_t)destWidth * (height / 2));
+
+    const int32_t iterations = 20;
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < iterations; i++)
+        DownsamplePixels((uint8_t*)dest.data(), destWidth * 4, (const uint8_t*)source.data(), width * 4, width, height);
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+    printf("Downsample %dx%d: %.2f ms, %.1f MB/s of source\n", width, height, seconds * 1000.0, ((double)width * height * 4.0) / seconds / 1e6);
+}
+
+int main()
+{
+    // Odd sizes so the last row and column are dropped, random pixels so every alpha and color mix appears..
+    const int32_t width  = 1023;
+    const int32_t height = 511;
+    std::vector<uint32_t> source((size_t)width * height);
+    srand(1);
+    for (auto& px : source)
+        px = (uint32_t)rand() * 2654435761u;
+    CheckAgainstReference(source, width, height);
+
+    // A single texel stays a single texel..
+    uint32_t one = 0x80FF0000;
+    uint32_t out = 0;
+    DownsamplePixels((uint8_t*)&out, 4, (const uint8_t*)&one, 4, 1, 1);
+    CHECK(out == one, "1x1 became %08X", out);
+
+    Benchmark(source, width, height);
+    std::vector<uint32_t> canvas(2048 * 1024);
+    for (auto& px : canvas)
+        px = (uint32_t)rand() * 2654435761u;
+    Benchmark(canvas, 2048, 1024);
+    return TestResult();
+}
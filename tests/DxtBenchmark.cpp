@@ -0,0 +1,145 @@
+#include "DxtEncoder.h"
+#include "TestCommon.h"
+#include <chrono>
+#include <math.h>
+#include <vector>
+
+// Expands a 5:6:5 endpoint to eight bits per channel, r g b order..
+static void Decode565(uint16_t color, int32_t* pRgb)
+{
+    int32_t r = (color >> 11) & 31;
+    int32_t g = (color >> 5) & 63;
+    int32_t b = color & 31;
+    pRgb[0]   = (r << 3) | (r >> 2);
+    pRgb[1]   = (g << 2) | (g >> 4);
+    pRgb[2]   = (b << 3) | (b >> 2);
+}
+
+// Decodes texel i (row major within the block) of a DXT3 or DXT5 block into A8R8G8B8..
+static uint32_t DecodeTexel(const uint8_t* block, int32_t i, DxtFormat format)
+{
+    int32_t alpha;
+    if (format == DxtFormat::DXT3)
+    {
+        alpha = ((block[i / 2] >> ((i & 1) * 4)) & 15) * 17;
+    }
+    else
+    {
+        int32_t a0 = block[0];
+        int32_t a1 = block[1];
+        uint64_t bits = 0;
+        for (auto k = 0; k < 6; k++)
+            bits |= (uint64_t)block[2 + k] << (8 * k);
+
+        int32_t palette[8] = {a0, a1};
+        if (a0 > a1)
+        {
+            for (auto k = 1; k < 7; k++)
+                palette[k + 1] = (((7 - k) * a0) + (k * a1)) / 7;
+        }
+        else
+        {
+            for (auto k = 1; k < 5; k++)
+                palette[k + 1] = (((5 - k) * a0) + (k * a1)) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+        alpha = palette[(bits >> (3 * i)) & 7];
+    }
+
+    int32_t e0[3], e1[3];
+    Decode565(block[8] | (block[9] << 8), e0);
+    Decode565(block[10] | (block[11] << 8), e1);
+    auto indices = (uint32_t)block[12] | ((uint32_t)block[13] << 8) | ((uint32_t)block[14] << 16) | ((uint32_t)block[15] << 24);
+    auto index   = (indices >> (2 * i)) & 3;
+
+    uint32_t px = (uint32_t)alpha << 24;
+    for (auto c = 0; c < 3; c++)
+    {
+        int32_t palette[4] = {e0[c], e1[c], ((2 * e0[c]) + e1[c]) / 3, (e0[c] + (2 * e1[c])) / 3};
+        px |= (uint32_t)palette[index] << (8 * (2 - c));
+    }
+    return px;
+}
+
+static double GetPsnr(double squaredError, double count)
+{
+    return (squaredError == 0.0) ? 99.0 : 10.0 * log10((255.0 * 255.0) / (squaredError / count));
+}
+
+// Text-like input: mostly empty or solid, with anti-aliased edges and a color gradient across it..
+static std::vector<uint32_t> MakeImage(int32_t width, int32_t height)
+{
+    std::vector<uint32_t> pixels((size_t)width * height);
+    for (auto y = 0; y < height; y++)
+    {
+        for (auto x = 0; x < width; x++)
+        {
+            auto shape = sin(x * 0.3) * sin(y * 0.25);
+            auto alpha = (shape > 0.3) ? 255 : ((shape < 0.0) ? 0 : (int32_t)(shape / 0.3 * 255.0));
+            auto red   = (x * 255) / width;
+            auto blue  = (y * 255) / height;
+            pixels[(y * width) + x] = ((uint32_t)alpha << 24) | ((uint32_t)red << 16) | (200u << 8) | (uint32_t)blue;
+        }
+    }
+    return pixels;
+}
+
+// Reports alpha PSNR over every texel, color PSNR over visible texels and encode throughput..
+static void Benchmark(const std::vector<uint32_t>& source, int32_t width, int32_t height, DxtFormat format, uint32_t threads)
+{
+    auto blocksWide = (width + 3) / 4;
+    auto blocksHigh = (height + 3) / 4;
+    std::vector<uint8_t> blocks((size_t)blocksWide * blocksHigh * 16);
+
+    const int32_t iterations = 10;
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < iterations; i++)
+        EncodeDxt(blocks.data(), blocksWide * 16, (const uint8_t*)source.data(), width * 4, width, height, format, false, threads);
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    double alphaError = 0.0;
+    double colorError = 0.0;
+    double colorCount = 0.0;
+    for (auto y = 0; y < height; y++)
+    {
+        for (auto x = 0; x < width; x++)
+        {
+            auto block    = blocks.data() + ((((y / 4) * blocksWide) + (x / 4)) * 16);
+            auto decoded  = DecodeTexel(block, ((y % 4) * 4) + (x % 4), format);
+            auto original = source[(y * width) + x];
+            double delta  = (double)(decoded >> 24) - (double)(original >> 24);
+            alphaError   += delta * delta;
+            if ((original >> 24) == 0)
+                continue;
+            for (auto c = 0; c < 3; c++)
+            {
+                delta       = (double)((decoded >> (8 * c)) & 0xFF) - (double)((original >> (8 * c)) & 0xFF);
+                colorError += delta * delta;
+            }
+            colorCount += 3.0;
+        }
+    }
+
+    auto alphaPsnr = GetPsnr(alphaError, (double)width * height);
+    auto colorPsnr = GetPsnr(colorError, colorCount);
+    printf("%s %dx%d, %u thread(s): alpha %.2f dB, color %.2f dB, %.1f MB/s\n", (format == DxtFormat::DXT3) ? "DXT3" : "DXT5", width, height, threads, alphaPsnr, colorPsnr,
+           ((double)width * height * 4.0) / seconds / 1e6);
+
+    // Loose floors, a regression in the encoder shows up far below these..
+    CHECK(alphaPsnr > 33.0, "alpha PSNR %.2f dB", alphaPsnr);
+    CHECK(colorPsnr > 30.0, "color PSNR %.2f dB", colorPsnr);
+}
+
+int main()
+{
+    const int32_t width  = 1003;
+    const int32_t height = 517;
+    auto source = MakeImage(width, height);
+    for (auto format : {DxtFormat::DXT3, DxtFormat::DXT5})
+    {
+        Benchmark(source, width, height, format, 1);
+        Benchmark(source, width, height, format, 8);
+    }
+    return TestResult();
+}
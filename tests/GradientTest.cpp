@@ -0,0 +1,206 @@
+#include "Gradient.h"
+#include "TestCommon.h"
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+// Start and end points the LinearGradientBrush used to get for each style..
+struct BrushLine_t
+{
+    uint32_t Style;
+    int32_t StartX;
+    int32_t StartY;
+    int32_t EndX;
+    int32_t EndY;
+};
+
+static const int32_t W = 120;
+static const int32_t H = 45;
+static const BrushLine_t g_BrushLines[] = {
+    {1, 0, 0, W, 0},
+    {2, 0, 0, W, H},
+    {3, 0, 0, 0, H},
+    {4, W, 0, 0, H},
+    {5, W, 0, 0, 0},
+    {6, W, H, 0, 0},
+    {7, 0, H, 0, 0},
+    {8, 0, H, W, 0},
+    {0, 0, 0, W, 0},
+    {9, 0, 0, W, 0},
+};
+
+// Position of a pixel center along the line, 0 at the start and 1 at the end, as the brush projected it..
+static double Project(const BrushLine_t& line, int32_t x, int32_t y)
+{
+    auto dx = (double)(line.EndX - line.StartX);
+    auto dy = (double)(line.EndY - line.StartY);
+    return ((((double)x + 0.5) - line.StartX) * dx + (((double)y + 0.5) - line.StartY) * dy) / (dx * dx + dy * dy);
+}
+
+static void TestLines()
+{
+    for (const auto& line : g_BrushLines)
+    {
+        GradientShape_t shape;
+        GetGradientLine(line.Style, W, H, &shape);
+        CHECK(shape.Kind == GradientKind::Linear, "style %u is not linear", line.Style);
+        CHECK((shape.StartX == (float)line.StartX) && (shape.StartY == (float)line.StartY) && (shape.EndX == (float)line.EndX) && (shape.EndY == (float)line.EndY),
+            "style %u runs %.0f,%.0f to %.0f,%.0f, the brush ran %d,%d to %d,%d", line.Style, shape.StartX, shape.StartY, shape.EndX, shape.EndY, line.StartX, line.StartY, line.EndX, line.EndY);
+
+        // Every pixel takes the ramp entry of its projection, clamped past either end..
+        std::vector<int32_t> indices(W);
+        for (auto y = 0; y < H; y++)
+        {
+            GetGradientIndices(shape, 0, y, W, indices.data());
+            for (auto x = 0; x < W; x++)
+            {
+                auto t        = Project(line, x, y);
+                auto expected = (int32_t)floor(fmin(fmax(t, 0.0), 1.0) * (GradientLutSize - 1) + 0.5);
+                CHECK(abs(indices[x] - expected) <= 1, "style %u pixel %d,%d has index %d, expected %d", line.Style, x, y, indices[x], expected);
+            }
+        }
+
+        // The pixels at the two ends of the line sit at the two ends of the ramp..
+        auto cornerX = (line.StartX == 0) ? 0 : (W - 1);
+        auto cornerY = (line.StartY == 0) ? 0 : (H - 1);
+        GetGradientIndices(shape, cornerX, cornerY, 1, indices.data());
+        CHECK(indices[0] <= 3, "style %u start pixel has index %d", line.Style, indices[0]);
+        cornerX = (line.EndX == 0) ? 0 : (W - 1);
+        cornerY = (line.EndY == 0) ? 0 : (H - 1);
+        GetGradientIndices(shape, cornerX, cornerY, 1, indices.data());
+        CHECK(indices[0] >= (GradientLutSize - 4), "style %u end pixel has index %d", line.Style, indices[0]);
+    }
+}
+
+static uint32_t Channel(uint32_t color, int32_t shift)
+{
+    return (color >> shift) & 0xFF;
+}
+
+static void TestRamps()
+{
+    // Two colors interpolate every channel across the ramp, the old brush's start and end colors at either end..
+    uint32_t lut[GradientLutSize];
+    BuildGradientLut(0x00FF8000, 0xFF0080FF, lut);
+    CHECK(lut[0] == 0x00FF8000, "ramp starts at %08X", lut[0]);
+    CHECK(lut[GradientLutSize - 1] == 0xFF0080FF, "ramp ends at %08X", lut[GradientLutSize - 1]);
+    for (auto i = 0; i < GradientLutSize; i++)
+    {
+        auto t = (double)i / (GradientLutSize - 1);
+        for (auto shift = 0; shift < 32; shift += 8)
+        {
+            auto a        = (double)Channel(0x00FF8000, shift);
+            auto b        = (double)Channel(0xFF0080FF, shift);
+            auto expected = (int32_t)floor(a + (b - a) * t + 0.5);
+            CHECK(abs((int32_t)Channel(lut[i], shift) - expected) <= 1, "ramp entry %d shift %d is %u, expected %d", i, shift, Channel(lut[i], shift), expected);
+        }
+    }
+
+    // Stops hold their color before the first and after the last, and are hit exactly at their position..
+    GradientStop_t stops[] = {{0.2f, 0xFFFF0000}, {0.6f, 0x8000FF00}, {0.8f, 0xFF0000FF}};
+    BuildGradientRamp(stops, 3, lut);
+    CHECK(lut[0] == 0xFFFF0000, "before the first stop is %08X", lut[0]);
+    CHECK(lut[51] == 0xFFFF0000, "the first stop is %08X", lut[51]);
+    CHECK(lut[153] == 0x8000FF00, "the middle stop is %08X", lut[153]);
+    CHECK(lut[204] == 0xFF0000FF, "the last stop is %08X", lut[204]);
+    CHECK(lut[GradientLutSize - 1] == 0xFF0000FF, "after the last stop is %08X", lut[GradientLutSize - 1]);
+
+    // Halfway between the first two stops, t = 0.4 is entry 102..
+    auto mid = lut[102];
+    CHECK((abs((int32_t)Channel(mid, 16) - 128) <= 1) && (abs((int32_t)Channel(mid, 8) - 128) <= 1) && (Channel(mid, 0) == 0) && (abs((int32_t)Channel(mid, 24) - 192) <= 1),
+        "halfway between stops is %08X", mid);
+
+    BuildGradientRamp(stops, 1, lut);
+    CHECK((lut[0] == 0xFFFF0000) && (lut[GradientLutSize - 1] == 0xFFFF0000), "a single stop is not solid");
+    BuildGradientRamp(stops, 0, lut);
+    CHECK((lut[0] == 0) && (lut[GradientLutSize - 1] == 0), "no stops is not empty");
+}
+
+// Index distance, angular ramps wrap so the first and last entries are neighbours..
+static int32_t IndexDistance(GradientKind kind, int32_t a, int32_t b)
+{
+    auto distance = abs(a - b);
+    if (kind == GradientKind::Angular)
+        distance = (distance < (GradientLutSize - distance)) ? distance : (GradientLutSize - distance);
+    return distance;
+}
+
+// Double precision index for a pixel center, the reference for both paths..
+static int32_t ReferenceIndex(const GradientShape_t& shape, double x, double y)
+{
+    auto dx     = x - shape.StartX;
+    auto dy     = y - shape.StartY;
+    auto lx     = (double)shape.EndX - shape.StartX;
+    auto ly     = (double)shape.EndY - shape.StartY;
+    auto length = sqrt(lx * lx + ly * ly);
+    double position;
+    if (shape.Kind == GradientKind::Linear)
+    {
+        position = (dx * lx + dy * ly) / (length * length);
+    }
+    else if (shape.Kind == GradientKind::Radial)
+    {
+        position = sqrt(dx * dx + dy * dy) / length;
+    }
+    else
+    {
+        auto ux    = lx / length;
+        auto uy    = ly / length;
+        auto turns = atan2(dy * ux - dx * uy, dx * ux + dy * uy) / 6.283185307179586;
+        position   = (turns < 0.0) ? (turns + 1.0) : turns;
+    }
+    return (int32_t)floor(fmin(fmax(position, 0.0), 1.0) * (GradientLutSize - 1) + 0.5);
+}
+
+// Spans of four go through sse2 where it is available and the rest through the scalar ShadeIndex, asking for a
+// single pixel always takes the scalar path. Both have to land within a step of each other and of the reference..
+static void CompareVectorAndScalar(const GradientShape_t& shape, const char* name)
+{
+    std::vector<int32_t> row(64);
+    auto worst = 0;
+    for (auto width = 1; width <= 41; width += 4)
+    {
+        for (auto x = -3; x < 60; x += 7)
+        {
+            for (auto y = -2; y < 50; y += 3)
+            {
+                GetGradientIndices(shape, x, y, width, row.data());
+                for (auto i = 0; i < width; i++)
+                {
+                    int32_t scalar;
+                    GetGradientIndices(shape, x + i, y, 1, &scalar);
+                    auto reference = ReferenceIndex(shape, (double)(x + i) + 0.5, (double)y + 0.5);
+                    auto distance  = IndexDistance(shape.Kind, row[i], scalar);
+                    worst          = (distance > worst) ? distance : worst;
+                    CHECK(distance <= 1, "%s span of %d at %d,%d: pixel %d is %d, scalar gives %d", name, width, x, y, i, row[i], scalar);
+                    CHECK(IndexDistance(shape.Kind, scalar, reference) <= 1, "%s pixel %d,%d is %d, reference %d", name, x + i, y, scalar, reference);
+                    CHECK((row[i] >= 0) && (row[i] < GradientLutSize), "%s index %d out of the ramp", name, row[i]);
+                }
+            }
+        }
+    }
+    printf("%s: vector and scalar differ by at most %d\n", name, worst);
+}
+
+static void TestVectorPaths()
+{
+    const GradientShape_t shapes[] = {
+        {GradientKind::Radial, 20.0f, 15.0f, 60.0f, 15.0f},
+        {GradientKind::Radial, 3.5f, 40.25f, 10.0f, 2.0f},
+        {GradientKind::Angular, 20.0f, 15.0f, 60.0f, 15.0f},
+        {GradientKind::Angular, 30.5f, 20.5f, 30.5f, 0.0f},
+        {GradientKind::Angular, 7.3f, 33.9f, -5.0f, 41.0f},
+        {GradientKind::Linear, 4.0f, 9.0f, 51.0f, 23.0f},
+    };
+    const char* names[] = {"radial", "radial off center", "angular", "angular on a pixel center", "angular tilted", "linear"};
+    for (auto i = 0; i < 6; i++)
+        CompareVectorAndScalar(shapes[i], names[i]);
+}
+
+int main()
+{
+    TestLines();
+    TestRamps();
+    TestVectorPaths();
+    return TestResult();
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "MarkupParser.h"
+#include "TestCommon.h"
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct Run_t
+{
+    std::string Text;
+    MarkupStyle_t Style;
+    bool NewLine;
+};
+
+static const MarkupStyle_t g_Base = {0xFFFFFFFF, 12.0f, 0};
+
+// Runs of ASCII markup, read back as narrow strings so they are easy to compare..
+static std::vector<Run_t> Parse(const char* markup)
+{
+    static std::vector<uint16_t> text;
+    text.assign(markup, markup + strlen(markup));
+
+    std::vector<Run_t> runs;
+    MarkupParser parser(text.data(), (uint32_t)text.size(), g_Base);
+    MarkupRun_t run;
+    while (parser.Next(&run))
+    {
+        CHECK((run.Text >= text.data()) && ((run.Text + run.Length) <= (text.data() + text.size())), "run of \"%s\" points outside the text", markup);
+        Run_t copy = {std::string(run.Text, run.Text + run.Length), run.Style, run.NewLine};
+        runs.push_back(copy);
+        CHECK(runs.size() <= 64, "\"%s\" never stops", markup);
+        if (runs.size() > 64)
+            break;
+    }
+    return runs;
+}
+
+// The text of every run joined with | and a newline marker, so whole results compare as one string..
+static std::string Join(const std::vector<Run_t>& runs)
+{
+    std::string joined;
+    for (const auto& run : runs)
+    {
+        if (&run != &runs[0])
+            joined += "|";
+        if (run.NewLine)
+            joined += "^";
+        joined += run.Text;
+    }
+    return joined;
+}
+
+static void CheckText(const char* markup, const char* expected)
+{
+    auto joined = Join(Parse(markup));
+    CHECK(joined == expected, "\"%s\" gave \"%s\", expected \"%s\"", markup, joined.c_str(), expected);
+}
+
+static void TestStyles()
+{
+    auto runs = Parse("a<b>b<i>c<u>d</u>e</>f</b>g");
+    CHECK(Join(runs) == "a|b|c|d|e|f|g", "styled runs are %s", Join(runs).c_str());
+    const int32_t flags[] = {0, MarkupBold, MarkupBold | MarkupItalic, MarkupBold | MarkupItalic | MarkupUnderline, MarkupBold | MarkupItalic, MarkupBold, 0};
+    for (size_t i = 0; (i < runs.size()) && (i < 7); i++)
+        CHECK(runs[i].Style.Flags == flags[i], "run %zu has flags %d, expected %d", i, runs[i].Style.Flags, flags[i]);
+
+    runs = Parse("<c=FF8000>x<c=80102030>y</c>z</c>w");
+    CHECK(runs.size() == 4, "color runs: %zu", runs.size());
+    if (runs.size() == 4)
+    {
+        CHECK(runs[0].Style.Color == 0xFFFF8000, "six digits give an opaque color, got %08X", runs[0].Style.Color);
+        CHECK(runs[1].Style.Color == 0x80102030, "eight digits keep their alpha, got %08X", runs[1].Style.Color);
+        CHECK(runs[2].Style.Color == 0xFFFF8000, "closing restores the outer color, got %08X", runs[2].Style.Color);
+        CHECK(runs[3].Style.Color == g_Base.Color, "closing everything restores the base color, got %08X", runs[3].Style.Color);
+    }
+
+    runs = Parse("<size=20>x<size=7.5>y</>z");
+    CHECK(runs.size() == 3, "size runs: %zu", runs.size());
+    if (runs.size() == 3)
+    {
+        CHECK(runs[0].Style.Size == 20.0f, "size is %f", runs[0].Style.Size);
+        CHECK((runs[1].Style.Size > 7.49f) && (runs[1].Style.Size < 7.51f), "fractional size is %f", runs[1].Style.Size);
+        CHECK(runs[2].Style.Size == 20.0f, "closing restores the size, got %f", runs[2].Style.Size);
+        CHECK(runs[0].Style.Color == g_Base.Color, "size changed the color");
+    }
+
+    // Closing more than was opened stays at the base style..
+    runs = Parse("</b></>a");
+    CHECK((Join(runs) == "a") && (runs[0].Style.Flags == 0) && (runs[0].Style.Size == g_Base.Size), "extra closing tags: %s", Join(runs).c_str());
+}
+
+static void TestLiteralText()
+{
+    CheckText("a<<b", "a|<|b");
+    CheckText("<<b>", "<|b>");
+    CheckText("<<<b>x", "<|x");
+    CheckText("a<x>b", "a|<x>b");
+    CheckText("<c=12345>a", "<c=12345>a");
+    CheckText("<c=GGGGGG>a", "<c=GGGGGG>a");
+    CheckText("<size=0>a", "<size=0>a");
+    CheckText("<size=>a", "<size=>a");
+    CheckText("<size=1.2.3>a", "<size=1.2.3>a");
+    CheckText("<>a", "<>a");
+    CheckText("a<b", "a|<b");
+    CheckText("a<", "a|<");
+    CheckText("<bold>a", "<bold>a");
+
+    // Tags are only looked for within a short reach of the opening bracket..
+    CheckText("<c=FF0000                                 >a", "<c=FF0000                                 >a");
+
+    auto runs = Parse("<b>a<x>b");
+    CHECK((runs.size() == 2) && (runs[1].Style.Flags == MarkupBold), "unknown tags keep the style");
+}
+
+static void TestNesting()
+{
+    // The base style and 15 tags fill the stack, tags past it change nothing but their closing tags are
+    // still matched..
+    std::string markup;
+    for (auto i = 0; i < 14; i++)
+        markup += "<b>";
+    markup += "<i>a<u>b";
+    for (auto i = 0; i < 4; i++)
+        markup += "<i>";
+    markup += "c</></></></></>d</>e";
+
+    auto runs = Parse(markup.c_str());
+    CHECK(Join(runs) == "a|b|c|d|e", "nested runs are %s", Join(runs).c_str());
+    const int32_t flags[] = {MarkupBold | MarkupItalic, MarkupBold | MarkupItalic, MarkupBold | MarkupItalic, MarkupBold | MarkupItalic, MarkupBold};
+    for (size_t i = 0; (i < runs.size()) && (i < 5); i++)
+        CHECK(runs[i].Style.Flags == flags[i], "nested run %zu has flags %d, expected %d", i, runs[i].Style.Flags, flags[i]);
+}
+
+static void TestLines()
+{
+    CheckText("", "");
+    CheckText("\n", "");
+    CheckText("a\nb", "a|^b");
+    CheckText("a\n", "a");
+    CheckText("\na", "|^a");
+    CheckText("a\n\nb", "a|^|^b");
+    CheckText("a\n\n\nb", "a|^|^|^b");
+    CheckText("<b>\n</b>a", "|^a");
+    CheckText("a<b>\nb", "a|^b");
+    CheckText("a<<\n<<", "a|<|^<");
+
+    // A style carries over to the next line..
+    auto runs = Parse("<b>a\nb");
+    CHECK((runs.size() == 2) && (runs[1].Style.Flags == MarkupBold) && runs[1].NewLine, "styles carry across lines");
+
+    // Copying the parser saves the position..
+    std::vector<uint16_t> text = {'<', 'b', '>', 'a', '\n', 'b'};
+    MarkupParser parser(text.data(), (uint32_t)text.size(), g_Base);
+    MarkupRun_t run;
+    parser.Next(&run);
+    auto saved = parser;
+    MarkupRun_t first;
+    MarkupRun_t second;
+    CHECK(parser.Next(&first) && saved.Next(&second), "copied parsers both continue");
+    CHECK((first.Text == second.Text) && (first.Length == second.Length) && (first.Style.Flags == second.Style.Flags) && (first.NewLine == second.NewLine), "copied parsers disagree");
+}
+
+int main()
+{
+    TestStyles();
+    TestLiteralText();
+    TestNesting();
+    TestLines();
+    return TestResult();
+}
\ No newline at end of file
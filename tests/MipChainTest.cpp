@@ -0,0 +1,131 @@
+#include "PixelKernels.h"
+#include "TestCommon.h"
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+// Alpha weighted gamma 2 average of the 2x2 footprint of texel x, y, with the last row and column repeated
+// where the level is a single pixel wide..
+static uint32_t FilterTexel(const uint8_t* source, int32_t pitch, int32_t width, int32_t height, int32_t x, int32_t y, int32_t channel)
+{
+    double alpha = 0.0;
+    double color = 0.0;
+    for (auto dy = 0; dy < 2; dy++)
+    {
+        for (auto dx = 0; dx < 2; dx++)
+        {
+            auto sx = ((2 * x + dx) < width) ? (2 * x + dx) : (width - 1);
+            auto sy = ((2 * y + dy) < height) ? (2 * y + dy) : (height - 1);
+            auto px = *(const uint32_t*)(source + (sy * pitch) + (sx * 4));
+            auto a  = (double)(px >> 24);
+            auto v  = (double)((px >> (8 * channel)) & 0xFF);
+            alpha  += a;
+            color  += v * v * a;
+        }
+    }
+    if (channel == 3)
+        return (uint32_t)((alpha / 4.0) + 0.5);
+    return (alpha == 0.0) ? 0 : (uint32_t)(sqrt(color / alpha) + 0.5);
+}
+
+// Runs the whole chain down to 1x1 and checks every level against a box filter of the level above it, read
+// with that level's own size and pitch..
+static void CheckChain(int32_t width, int32_t height, int32_t sourcePitch)
+{
+    std::vector<uint8_t> source((size_t)sourcePitch * height);
+    for (auto& value : source)
+        value = (uint8_t)(rand() >> 4);
+
+    MipChain chain(source.data(), sourcePitch, width, height);
+    std::vector<uint8_t> previous = source;
+    auto previousPitch  = sourcePitch;
+    auto previousWidth  = width;
+    auto previousHeight = height;
+    auto levels         = 0;
+    while ((chain.GetWidth() > 1) || (chain.GetHeight() > 1))
+    {
+        CHECK(chain.Next(), "%dx%d level %d failed", width, height, levels + 1);
+        levels++;
+
+        auto levelWidth  = (previousWidth > 1) ? (previousWidth / 2) : 1;
+        auto levelHeight = (previousHeight > 1) ? (previousHeight / 2) : 1;
+        CHECK((chain.GetWidth() == levelWidth) && (chain.GetHeight() == levelHeight), "%dx%d level %d is %dx%d", width, height, levels, chain.GetWidth(), chain.GetHeight());
+        CHECK(chain.GetPitch() >= (chain.GetWidth() * 4), "%dx%d level %d pitch %d", width, height, levels, chain.GetPitch());
+
+        for (auto y = 0; y < chain.GetHeight(); y++)
+        {
+            for (auto x = 0; x < chain.GetWidth(); x++)
+            {
+                auto px = *(const uint32_t*)(chain.GetPixels() + (y * chain.GetPitch()) + (x * 4));
+                if ((px >> 24) == 0)
+                {
+                    CHECK(FilterTexel(previous.data(), previousPitch, previousWidth, previousHeight, x, y, 3) == 0, "%dx%d level %d texel %d,%d lost its alpha", width, height, levels, x, y);
+                    continue;
+                }
+                for (auto c = 0; c < 4; c++)
+                {
+                    auto expected = (int32_t)FilterTexel(previous.data(), previousPitch, previousWidth, previousHeight, x, y, c);
+                    auto actual   = (int32_t)((px >> (8 * c)) & 0xFF);
+                    CHECK(abs(expected - actual) <= 1, "%dx%d level %d texel %d,%d channel %d is %d, expected %d", width, height, levels, x, y, c, actual, expected);
+                }
+            }
+        }
+
+        // Keep a copy, the chain reuses its buffer two levels on..
+        previousPitch  = chain.GetPitch();
+        previousWidth  = chain.GetWidth();
+        previousHeight = chain.GetHeight();
+        previous.assign(chain.GetPixels(), chain.GetPixels() + ((size_t)previousPitch * previousHeight));
+        if (levels > 16)
+            break;
+    }
+
+    auto expectedLevels = 0;
+    for (auto w = width, h = height; (w > 1) || (h > 1); w = (w > 1) ? (w / 2) : 1, h = (h > 1) ? (h / 2) : 1)
+        expectedLevels++;
+    CHECK(levels == expectedLevels, "%dx%d gave %d levels, expected %d", width, height, levels, expectedLevels);
+}
+
+// Alpha is a plain average, so each texel of a power of two chain is the mean alpha of its whole footprint
+// in the source, give or take a rounding step per level..
+static void CheckAlphaFootprint(int32_t size)
+{
+    std::vector<uint32_t> source((size_t)size * size);
+    for (auto& px : source)
+        px = (uint32_t)rand() * 2654435761u;
+
+    MipChain chain((const uint8_t*)source.data(), size * 4, size, size);
+    for (auto level = 1; chain.GetWidth() > 1; level++)
+    {
+        chain.Next();
+        auto scale = size / chain.GetWidth();
+        for (auto y = 0; y < chain.GetHeight(); y++)
+        {
+            for (auto x = 0; x < chain.GetWidth(); x++)
+            {
+                double total = 0.0;
+                for (auto sy = 0; sy < scale; sy++)
+                {
+                    for (auto sx = 0; sx < scale; sx++)
+                        total += (double)(source[((y * scale + sy) * size) + (x * scale) + sx] >> 24);
+                }
+                auto expected = total / (double)(scale * scale);
+                auto actual   = (double)(*(const uint32_t*)(chain.GetPixels() + (y * chain.GetPitch()) + (x * 4)) >> 24);
+                CHECK(fabs(expected - actual) <= (double)level, "%d level %d texel %d,%d alpha %.0f, expected %.2f", size, level, x, y, actual, expected);
+            }
+        }
+    }
+}
+
+int main()
+{
+    srand(5);
+    CheckChain(256, 256, 256 * 4);
+    CheckChain(256, 64, 300 * 4);
+    CheckChain(37, 23, 40 * 4);
+    CheckChain(1, 9, 4);
+    CheckChain(64, 1, 64 * 4);
+    CheckChain(1, 1, 4);
+    CheckAlphaFootprint(256);
+    return TestResult();
+}
\ No newline at end of file
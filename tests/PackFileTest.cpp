@@ -0,0 +1,198 @@
+#include "PackFile.h"
+#include "TestCommon.h"
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Layout the tests poke at: an 8 byte file header, then records of a 32 byte header followed by the pixels..
+static const uint64_t FileHeaderSize   = 8;
+static const uint64_t RecordHeaderSize = 32;
+
+static std::string g_Path;
+static std::vector<uint32_t> g_Image;
+
+// Records are written from g_Image with a pitch of 100 pixels, starting first pixels in..
+static bool FindPixels(PackFile& pack, uint64_t key, int32_t width, int32_t height, uint32_t first)
+{
+    int32_t foundWidth, foundHeight;
+    const uint8_t* pixels;
+    if (!pack.Find(key, &foundWidth, &foundHeight, &pixels))
+        return false;
+    return (foundWidth == width) && (foundHeight == height) && (((const uint32_t*)pixels)[0] == g_Image[first]) && (((const uint32_t*)pixels)[width] == g_Image[100 + first]);
+}
+
+static void PatchByte(uint64_t offset, uint8_t value)
+{
+    FILE* file = fopen(g_Path.c_str(), "r+b");
+    fseek(file, (long)offset, SEEK_SET);
+    fputc(value, file);
+    fclose(file);
+}
+
+static void TestRoundTrip()
+{
+    std::filesystem::remove(g_Path);
+    PackFile pack;
+    CHECK(pack.Open(g_Path.c_str(), 1 << 20), "could not create pack");
+    CHECK(pack.Insert(1, 10, 5, (const uint8_t*)g_Image.data(), 400), "insert failed");
+    CHECK(FindPixels(pack, 1, 10, 5, 0), "record written this session not found");
+
+    // Records appended after the last lookup are read like any other..
+    CHECK(pack.Insert(2, 20, 3, (const uint8_t*)(g_Image.data() + 1), 400), "insert failed");
+    CHECK(FindPixels(pack, 2, 20, 3, 1), "appended record not found");
+    CHECK(FindPixels(pack, 1, 10, 5, 0), "earlier record lost after append");
+
+    int32_t width, height;
+    const uint8_t* pixels;
+    CHECK(!pack.Find(3, &width, &height, &pixels), "missing key found");
+    CHECK(!pack.Insert(4, 0, 5, (const uint8_t*)g_Image.data(), 400), "empty bitmap accepted");
+    CHECK(!pack.Insert(4, 5000, 1, (const uint8_t*)g_Image.data(), 400), "oversized bitmap accepted");
+}
+
+static void TestReopen()
+{
+    PackFile pack;
+    CHECK(pack.Open(g_Path.c_str(), 1 << 20), "could not reopen pack");
+    CHECK(FindPixels(pack, 1, 10, 5, 0), "record 1 not found after reopening");
+    CHECK(FindPixels(pack, 2, 20, 3, 1), "record 2 not found after reopening");
+
+    // A later record with the same key wins, in this session and the next..
+    CHECK(pack.Insert(1, 10, 5, (const uint8_t*)(g_Image.data() + 2), 400), "replacing insert failed");
+    CHECK(FindPixels(pack, 1, 10, 5, 2), "replacement not found");
+    pack.Close();
+    CHECK(pack.Open(g_Path.c_str(), 1 << 20), "could not reopen pack");
+    CHECK(FindPixels(pack, 1, 10, 5, 2), "replacement lost after reopening");
+}
+
+static void TestSizeLimit()
+{
+    std::filesystem::remove(g_Path);
+    PackFile pack;
+    CHECK(pack.Open(g_Path.c_str(), FileHeaderSize + RecordHeaderSize + 200), "could not create pack");
+    CHECK(pack.Insert(1, 10, 5, (const uint8_t*)g_Image.data(), 400), "record that fits exactly was refused");
+    CHECK(!pack.Insert(2, 1, 1, (const uint8_t*)g_Image.data(), 4), "record past the size limit was accepted");
+}
+
+// A flipped pixel byte fails the checksum on first read, a torn tail is cut off when the pack is opened..
+static void TestCorruptRecords()
+{
+    std::filesystem::remove(g_Path);
+    {
+        PackFile pack;
+        pack.Open(g_Path.c_str(), 1 << 20);
+        pack.Insert(1, 10, 5, (const uint8_t*)g_Image.data(), 400);
+        pack.Insert(2, 20, 3, (const uint8_t*)g_Image.data(), 400);
+    }
+    auto size = std::filesystem::file_size(g_Path);
+    PatchByte(FileHeaderSize + RecordHeaderSize + 5, 0x55);
+    std::filesystem::resize_file(g_Path, size - 10);
+
+    PackFile pack;
+    CHECK(pack.Open(g_Path.c_str(), 1 << 20), "could not open damaged pack");
+    CHECK(std::filesystem::file_size(g_Path) == (FileHeaderSize + RecordHeaderSize + 200), "torn record was not cut off, size %llu", (unsigned long long)std::filesystem::file_size(g_Path));
+    CHECK(!FindPixels(pack, 1, 10, 5, 0), "record with a bad checksum was returned");
+    CHECK(!FindPixels(pack, 2, 20, 3, 0), "torn record was returned");
+
+    // Writing carries on after the good part..
+    CHECK(pack.Insert(2, 20, 3, (const uint8_t*)g_Image.data(), 400), "insert after repair failed");
+    CHECK(FindPixels(pack, 2, 20, 3, 0), "record written after repair not found");
+}
+
+// A record header claiming an impossible size ends the valid part of the file..
+static void TestCorruptHeader()
+{
+    std::filesystem::remove(g_Path);
+    {
+        PackFile pack;
+        pack.Open(g_Path.c_str(), 1 << 20);
+        pack.Insert(1, 10, 5, (const uint8_t*)g_Image.data(), 400);
+        pack.Insert(2, 20, 3, (const uint8_t*)g_Image.data(), 400);
+    }
+    PatchByte(FileHeaderSize + RecordHeaderSize + 200 + 16, 0xFF);
+
+    PackFile pack;
+    CHECK(pack.Open(g_Path.c_str(), 1 << 20), "could not open damaged pack");
+    CHECK(FindPixels(pack, 1, 10, 5, 0), "good record before the damage was lost");
+    CHECK(!FindPixels(pack, 2, 20, 3, 0), "record with a damaged header was returned");
+    CHECK(std::filesystem::file_size(g_Path) == (FileHeaderSize + RecordHeaderSize + 200), "damaged record was not cut off");
+}
+
+// A file that isn't a pack is started over rather than trusted..
+static void TestForeignFile()
+{
+    PatchByte(0, 0);
+    PackFile pack;
+    CHECK(pack.Open(g_Path.c_str(), 1 << 20), "could not open foreign file");
+    CHECK(std::filesystem::file_size(g_Path) == FileHeaderSize, "foreign file was not reset");
+    CHECK(!FindPixels(pack, 1, 10, 5, 0), "record from a foreign file was returned");
+}
+
+// Paths are UTF-8 all the way down..
+static void TestUtf8Path()
+{
+    auto path = std::filesystem::temp_directory_path() / std::filesystem::path(u8"PackFileTest-\u00E9\u65E5.bin");
+    auto utf8 = path.u8string();
+    std::filesystem::remove(path);
+    {
+        PackFile pack;
+        CHECK(pack.Open((const char*)utf8.c_str(), 1 << 20), "could not create pack with a UTF-8 path");
+        CHECK(pack.Insert(1, 10, 5, (const uint8_t*)g_Image.data(), 400), "insert failed");
+    }
+    PackFile pack;
+    CHECK(std::filesystem::exists(path), "pack was not created under its UTF-8 name");
+    CHECK(pack.Open((const char*)utf8.c_str(), 1 << 20) && FindPixels(pack, 1, 10, 5, 0), "record not found under a UTF-8 path");
+    pack.Close();
+    std::filesystem::remove(path);
+}
+
+// Prewarm workers insert while the main thread looks records up..
+static void TestConcurrentInsert()
+{
+    std::filesystem::remove(g_Path);
+    PackFile pack;
+    CHECK(pack.Open(g_Path.c_str(), 16 << 20), "could not create pack");
+    CHECK(pack.Insert(1000, 10, 5, (const uint8_t*)g_Image.data(), 400), "insert failed");
+
+    std::vector<std::thread> workers;
+    for (uint64_t worker = 0; worker < 2; worker++)
+    {
+        workers.emplace_back([&pack, worker]() {
+            for (uint64_t i = 0; i < 200; i++)
+                pack.Insert((worker * 200) + i, 10, 5, (const uint8_t*)(g_Image.data() + (i % 50)), 400);
+        });
+    }
+    auto found = true;
+    for (auto i = 0; i < 400; i++)
+        found = found && FindPixels(pack, 1000, 10, 5, 0);
+    for (auto& worker : workers)
+        worker.join();
+    CHECK(found, "record lost while others were inserted");
+
+    for (uint64_t key = 0; key < 400; key++)
+        CHECK(FindPixels(pack, key, 10, 5, (uint32_t)((key % 200) % 50)), "record %u written from a worker not found", (uint32_t)key);
+
+    // Everything written from the workers reads back after a reopen too..
+    pack.Close();
+    CHECK(pack.Open(g_Path.c_str(), 16 << 20), "could not reopen pack");
+    CHECK(FindPixels(pack, 399, 10, 5, 199 % 50), "worker record lost on reopen");
+}
+
+int main()
+{
+    g_Path = (std::filesystem::temp_directory_path() / "PackFileTest.bin").string();
+    g_Image.resize(100 * 50);
+    for (size_t i = 0; i < g_Image.size(); i++)
+        g_Image[i] = (uint32_t)(i * 2654435761u);
+
+    TestRoundTrip();
+    TestReopen();
+    TestSizeLimit();
+    TestCorruptRecords();
+    TestCorruptHeader();
+    TestForeignFile();
+    TestUtf8Path();
+    TestConcurrentInsert();
+    std::filesystem::remove(g_Path);
+    return TestResult();
+}
@@ -0,0 +1,50 @@
+#include "PixelKernels.h"
+#include "TestCommon.h"
+#include <vector>
+
+// Alpha is kept and every color channel has to come out exactly (c * a + 127) / 255..
+static void CheckPixel(uint32_t source, uint32_t dest)
+{
+    auto alpha = source >> 24;
+    CHECK((dest >> 24) == alpha, "pixel %08X alpha changed to %u", source, dest >> 24);
+    for (uint32_t shift = 0; shift < 24; shift += 8)
+    {
+        auto expected = ((((source >> shift) & 0xFF) * alpha) + 127) / 255;
+        auto actual   = (dest >> shift) & 0xFF;
+        CHECK(actual == expected, "pixel %08X channel %u is %u, expected %u", source, shift / 8, actual, expected);
+    }
+}
+
+// Every (color, alpha) pair, once as a single row and once as a pitched block with an odd width so the vector
+// body, the tail and the row stepping are all covered..
+static void CheckAllPairs(bool streaming)
+{
+    std::vector<uint32_t> source(65536);
+    for (uint32_t color = 0; color < 256; color++)
+    {
+        for (uint32_t alpha = 0; alpha < 256; alpha++)
+            source[(color * 256) + alpha] = (alpha << 24) | (color << 16) | ((255 - color) << 8) | (color ^ 0x5A);
+    }
+
+    std::vector<uint32_t> row(65536);
+    BlitPixels((uint8_t*)row.data(), 65536 * 4, (const uint8_t*)source.data(), 65536 * 4, 65536, 1, BlitFormat::A8R8G8B8, BlitFlagPremultiply, streaming);
+    for (uint32_t i = 0; i < 65536; i++)
+        CheckPixel(source[i], row[i]);
+
+    std::vector<uint32_t> block(65536, 0xDEADBEEF);
+    BlitPixels((uint8_t*)block.data(), 256 * 4, (const uint8_t*)source.data(), 256 * 4, 253, 256, BlitFormat::A8R8G8B8, BlitFlagPremultiply, streaming);
+    for (uint32_t i = 0; i < 65536; i++)
+    {
+        if ((i % 256) < 253)
+            CheckPixel(source[i], block[i]);
+        else
+            CHECK(block[i] == 0xDEADBEEF, "pixel %u past the row was written", i);
+    }
+}
+
+int main()
+{
+    CheckAllPairs(false);
+    CheckAllPairs(true);
+    return TestResult();
+}
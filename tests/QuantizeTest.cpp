@@ -0,0 +1,45 @@
+#include "PixelKernels.h"
+#include "TestCommon.h"
+#include <vector>
+
+// Without dithering every channel, alpha included, rounds to the nearest level..
+static uint32_t RoundLevel(uint32_t value, uint32_t maximum)
+{
+    return ((2 * value * maximum) + 255) / 510;
+}
+
+static void CheckFormat(BlitFormat format, const uint32_t bits[4], bool streaming)
+{
+    std::vector<uint32_t> source(65536);
+    for (uint32_t color = 0; color < 256; color++)
+    {
+        for (uint32_t alpha = 0; alpha < 256; alpha++)
+            source[(color * 256) + alpha] = (alpha << 24) | (color << 16) | ((255 - color) << 8) | (color ^ 0x5A);
+    }
+
+    std::vector<uint16_t> dest(65536);
+    BlitPixels((uint8_t*)dest.data(), 65536 * 2, (const uint8_t*)source.data(), 65536 * 4, 65536, 1, format, BlitFlagNone, streaming);
+    for (uint32_t i = 0; i < 65536; i++)
+    {
+        uint32_t expected = 0;
+        uint32_t shift    = 0;
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            expected |= RoundLevel((source[i] >> (c * 8)) & 0xFF, (1u << bits[c]) - 1) << shift;
+            shift    += bits[c];
+        }
+        CHECK(dest[i] == expected, "pixel %08X packed to %04X, expected %04X", source[i], dest[i], expected);
+    }
+}
+
+int main()
+{
+    const uint32_t a4r4g4b4[4] = {4, 4, 4, 4};
+    const uint32_t a1r5g5b5[4] = {5, 5, 5, 1};
+    for (auto streaming : {false, true})
+    {
+        CheckFormat(BlitFormat::A4R4G4B4, a4r4g4b4, streaming);
+        CheckFormat(BlitFormat::A1R5G5B5, a1r5g5b5, streaming);
+    }
+    return TestResult();
+}
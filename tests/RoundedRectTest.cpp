@@ -0,0 +1,139 @@
+#include "RectRasterizer.h"
+#include "TestCommon.h"
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+// Reference shapes are sampled 16x16 per pixel, the same geometry gdiplus fills for a path of four arcs..
+static const int32_t Samples = 16;
+
+static bool InsideRoundedRect(float x, float y, float left, float top, float right, float bottom, float radius)
+{
+    if ((x < left) || (x > right) || (y < top) || (y > bottom))
+        return false;
+    auto cx = (x < (left + radius)) ? (left + radius) : ((x > (right - radius)) ? (right - radius) : x);
+    auto cy = (y < (top + radius)) ? (top + radius) : ((y > (bottom - radius)) ? (bottom - radius) : y);
+    return (((x - cx) * (x - cx)) + ((y - cy) * (y - cy))) <= (radius * radius);
+}
+
+// Returns fill and outline coverage of pixel x, y..
+static void SampleCoverage(const RoundedRect_t& rect, int32_t x, int32_t y, float* pFill, float* pOutline)
+{
+    auto radius = rect.Radius;
+    radius      = (radius < ((rect.Right - rect.Left) / 2)) ? radius : ((rect.Right - rect.Left) / 2);
+    radius      = (radius < ((rect.Bottom - rect.Top) / 2)) ? radius : ((rect.Bottom - rect.Top) / 2);
+    auto half   = rect.OutlineWidth / 2;
+    auto inner  = (radius > half) ? (radius - half) : 0.0f;
+
+    int32_t fill = 0, outline = 0;
+    for (auto j = 0; j < Samples; j++)
+    {
+        for (auto i = 0; i < Samples; i++)
+        {
+            auto sx = x + ((i + 0.5f) / Samples);
+            auto sy = y + ((j + 0.5f) / Samples);
+            fill   += InsideRoundedRect(sx, sy, rect.Left, rect.Top, rect.Right, rect.Bottom, radius) ? 1 : 0;
+            if (rect.OutlineWidth > 0.0f)
+            {
+                auto outer = InsideRoundedRect(sx, sy, rect.Left - half, rect.Top - half, rect.Right + half, rect.Bottom + half, radius + half);
+                auto hole  = InsideRoundedRect(sx, sy, rect.Left + half, rect.Top + half, rect.Right - half, rect.Bottom - half, inner);
+                outline   += (outer && !hole) ? 1 : 0;
+            }
+        }
+    }
+    *pFill    = (float)fill / (Samples * Samples);
+    *pOutline = (float)outline / (Samples * Samples);
+}
+
+// Random sizes, radii and outline widths, each compared against the supersampled shape. Alpha may differ by a
+// few steps where the edge curves inside a pixel, on average it has to be well below one step..
+static void CheckAgainstReference()
+{
+    srand(3);
+    int32_t worst = 0;
+    int64_t total = 0;
+    int64_t count = 0;
+    for (auto iteration = 0; iteration < 60; iteration++)
+    {
+        auto width   = (rand() % 90) + 3;
+        auto height  = (rand() % 60) + 3;
+        auto outline = (iteration % 3) ? (float)(rand() % 6) : 0.0f;
+        auto inset   = outline / 2;
+
+        RoundedRect_t rect{};
+        rect.Left         = inset;
+        rect.Top          = inset;
+        rect.Right        = width - inset;
+        rect.Bottom       = height - inset;
+        rect.Radius       = (float)(rand() % 20);
+        rect.OutlineWidth = outline;
+        rect.OutlineColor = 0xFF204080;
+        rect.FillColor    = 0xC0FF8000;
+
+        std::vector<uint32_t> pixels((size_t)width * height);
+        RasterizeRoundedRect((uint8_t*)pixels.data(), width * 4, width, height, rect);
+
+        for (auto y = 0; y < height; y++)
+        {
+            for (auto x = 0; x < width; x++)
+            {
+                float fill, edge;
+                SampleCoverage(rect, x, y, &fill, &edge);
+                auto fillAlpha = (0xC0 / 255.0f) * fill;
+                auto alpha     = edge + (fillAlpha * (1.0f - edge));
+                auto expected  = (int32_t)((alpha * 255.0f) + 0.5f);
+                auto px        = pixels[(y * width) + x];
+                auto error     = abs(expected - (int32_t)(px >> 24));
+                worst          = (error > worst) ? error : worst;
+                total         += error;
+                count++;
+
+                // Pixels inside one part carry its color exactly, alpha is already covered above..
+                if ((fill == 1.0f) && (edge == 0.0f))
+                    CHECK((px & 0xFFFFFF) == (rect.FillColor & 0xFFFFFF), "%dx%d interior pixel %d,%d is %08X", width, height, x, y, px);
+                if (edge == 1.0f)
+                    CHECK((px & 0xFFFFFF) == (rect.OutlineColor & 0xFFFFFF), "%dx%d outline pixel %d,%d is %08X", width, height, x, y, px);
+            }
+        }
+    }
+
+    auto mean = (double)total / (double)count;
+    printf("alpha error against the supersampled shape: max %d, mean %.3f\n", worst, mean);
+    CHECK(worst <= 20, "max alpha error %d", worst);
+    CHECK(mean < 0.5, "mean alpha error %.3f", mean);
+}
+
+// A ramp fill takes the ramp color at each fully covered pixel..
+static void CheckGradientFill()
+{
+    const int32_t width  = 64;
+    const int32_t height = 24;
+    uint32_t lut[GradientLutSize];
+    BuildGradientLut(0xFFFF0000, 0xFF0000FF, lut);
+
+    RoundedRect_t rect{};
+    rect.Right     = (float)width;
+    rect.Bottom    = (float)height;
+    rect.Radius    = 6.0f;
+    rect.FillColor = 0xFFFFFFFF;
+    rect.FillRamp  = lut;
+    GetGradientLine(0, width, height, &rect.FillShape);
+
+    std::vector<uint32_t> pixels((size_t)width * height);
+    RasterizeRoundedRect((uint8_t*)pixels.data(), width * 4, width, height, rect);
+
+    int32_t indices[width];
+    GetGradientIndices(rect.FillShape, 0, height / 2, width, indices);
+    for (auto x = 0; x < width; x++)
+    {
+        auto px = pixels[((height / 2) * width) + x];
+        CHECK(px == lut[indices[x]], "gradient pixel %d is %08X, expected %08X", x, px, lut[indices[x]]);
+    }
+}
+
+int main()
+{
+    CheckAgainstReference();
+    CheckGradientFill();
+    return TestResult();
+}
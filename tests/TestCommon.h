@@ -0,0 +1,32 @@
+#ifndef __TestCommon_H_INCLUDED__
+#define __TestCommon_H_INCLUDED__
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Checks keep going after a failure so one run reports everything, main returns TestResult()..
+static int g_TestFailures = 0;
+
+#define CHECK(condition, ...)                                   \
+    do                                                          \
+    {                                                           \
+        if (!(condition))                                       \
+        {                                                       \
+            if (g_TestFailures++ < 20)                          \
+            {                                                   \
+                printf("%s:%d: %s: ", __FILE__, __LINE__, #condition); \
+                printf(__VA_ARGS__);                            \
+                printf("\n");                                   \
+            }                                                   \
+        }                                                       \
+    } while (0)
+
+static inline int TestResult()
+{
+    if (g_TestFailures != 0)
+        printf("%d check(s) failed\n", g_TestFailures);
+    else
+        printf("passed\n");
+    return (g_TestFailures != 0) ? 1 : 0;
+}
+#endif
@@ -0,0 +1,93 @@
+#include "TextureTracker.h"
+#include "TestCommon.h"
+
+static IDirect3DTexture8* Rebuild(const uint8_t*, int32_t width, int32_t height, D3DFORMAT, uint32_t)
+{
+    return new IDirect3DTexture8(width, height, D3DPOOL_DEFAULT);
+}
+
+// Mirrors the nine-slice cache, which hands the same handle to every caller that asks for the same slice..
+static void TestSharedHandle()
+{
+    TextureTracker tracker;
+    auto pTexture = new IDirect3DTexture8(16, 16, D3DPOOL_DEFAULT);
+    auto handle   = tracker.Track(pTexture, D3DPOOL_DEFAULT, 16, 16, std::vector<uint8_t>(16));
+    CHECK(handle != 0, "default pool textures get a handle");
+
+    // The cache keeps the creation reference, each caller holds one more..
+    pTexture->AddRef();
+    tracker.Share(handle);
+    pTexture->AddRef();
+
+    // Device lost: the cache and both callers let go of the old texture..
+    tracker.ReleaseDefaultPool();
+    pTexture->Release();
+    pTexture->Release();
+    pTexture->Release();
+    CHECK(IDirect3DTexture8::s_Alive == 0, "old texture freed, %d alive", IDirect3DTexture8::s_Alive);
+
+    tracker.Restore(Rebuild);
+    auto pFirst  = tracker.Claim(handle);
+    auto pSecond = tracker.Claim(handle);
+    CHECK(pFirst != nullptr, "first holder claims the rebuilt texture");
+    CHECK(pSecond != nullptr, "second holder claims the rebuilt texture");
+    CHECK(pFirst == pSecond, "both holders get the same texture");
+    CHECK(tracker.Claim(handle) == nullptr, "a third claim fails");
+    if (pFirst)
+        CHECK(pFirst->m_Refs == 3, "tracker and both holders hold a reference, got %u", pFirst->m_Refs);
+
+    // Claimed textures survive a sweep while held and go once both holders release them..
+    tracker.Sweep(16);
+    CHECK(tracker.GetCount() == 1, "held texture kept by the sweep");
+    if (pFirst)
+        pFirst->Release();
+    tracker.Sweep(16);
+    CHECK(tracker.GetCount() == 1, "texture kept while the second holder has it");
+    if (pSecond)
+        pSecond->Release();
+    tracker.Sweep(16);
+    CHECK(tracker.GetCount() == 0, "texture released once nobody holds it");
+    CHECK(IDirect3DTexture8::s_Alive == 0, "no textures leaked, %d alive", IDirect3DTexture8::s_Alive);
+}
+
+// A holder that never claims is forgotten at the next loss, the entry goes once every holder is gone..
+static void TestUnclaimedHolders()
+{
+    TextureTracker tracker;
+    auto pTexture = new IDirect3DTexture8(8, 8, D3DPOOL_DEFAULT);
+    auto handle   = tracker.Track(pTexture, D3DPOOL_DEFAULT, 8, 8, std::vector<uint8_t>(16));
+    tracker.Share(handle);
+    tracker.ReleaseDefaultPool();
+    pTexture->Release();
+
+    // Only one of the two holders comes back for it..
+    tracker.Restore(Rebuild);
+    auto pClaimed = tracker.Claim(handle);
+    CHECK(pClaimed != nullptr, "first claim after the first reset");
+    tracker.Sweep(16);
+    CHECK(tracker.GetCount() == 1, "unclaimed restore kept by the sweep");
+
+    tracker.ReleaseDefaultPool();
+    if (pClaimed)
+        pClaimed->Release();
+    tracker.Restore(Rebuild);
+    pClaimed = tracker.Claim(handle);
+    CHECK(pClaimed != nullptr, "remaining holder claims after the second reset");
+    CHECK(tracker.Claim(handle) == nullptr, "the holder that never claimed was forgotten");
+
+    // Nobody claims after the third reset, so the entry is dropped at the fourth..
+    tracker.ReleaseDefaultPool();
+    if (pClaimed)
+        pClaimed->Release();
+    tracker.Restore(Rebuild);
+    tracker.ReleaseDefaultPool();
+    CHECK(tracker.GetCount() == 0, "entry dropped once no holder is left, %u left", tracker.GetCount());
+    CHECK(IDirect3DTexture8::s_Alive == 0, "no textures leaked, %d alive", IDirect3DTexture8::s_Alive);
+}
+
+int main()
+{
+    TestSharedHandle();
+    TestUnclaimedHolders();
+    return TestResult();
+}
\ No newline at end of file
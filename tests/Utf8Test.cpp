@@ -0,0 +1,139 @@
+#include "TestCommon.h"
+#include "Utf8.h"
+#include <chrono>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Straightforward decoder following the Unicode well-formed byte sequence table, replacing each maximal subpart
+// of an ill-formed sequence with U+FFFD..
+static std::vector<uint16_t> ReferenceDecode(const uint8_t* s, size_t length)
+{
+    std::vector<uint16_t> out;
+    size_t i = 0;
+    while (i < length)
+    {
+        uint32_t lead = s[i];
+        if (lead < 0x80)
+        {
+            out.push_back((uint16_t)lead);
+            i++;
+            continue;
+        }
+
+        uint32_t count, low = 0x80, high = 0xBF, codePoint;
+        if ((lead >= 0xC2) && (lead <= 0xDF))
+            count = 1, codePoint = lead & 0x1F;
+        else if ((lead >= 0xE0) && (lead <= 0xEF))
+            count = 2, codePoint = lead & 0x0F, low = (lead == 0xE0) ? 0xA0 : 0x80, high = (lead == 0xED) ? 0x9F : 0xBF;
+        else if ((lead >= 0xF0) && (lead <= 0xF4))
+            count = 3, codePoint = lead & 0x07, low = (lead == 0xF0) ? 0x90 : 0x80, high = (lead == 0xF4) ? 0x8F : 0xBF;
+        else
+        {
+            out.push_back(0xFFFD);
+            i++;
+            continue;
+        }
+
+        // The first continuation byte has a narrower range for some leads, the rest are always 80..BF..
+        size_t next = i + 1;
+        uint32_t valid = 0;
+        while ((valid < count) && (next < length) && (s[next] >= low) && (s[next] <= high))
+        {
+            codePoint = (codePoint << 6) | (s[next] & 0x3F);
+            low       = 0x80;
+            high      = 0xBF;
+            valid++;
+            next++;
+        }
+        i = next;
+        if (valid != count)
+            out.push_back(0xFFFD);
+        else if (codePoint >= 0x10000)
+        {
+            out.push_back((uint16_t)(0xD800 + ((codePoint - 0x10000) >> 10)));
+            out.push_back((uint16_t)(0xDC00 + ((codePoint - 0x10000) & 0x3FF)));
+        }
+        else
+            out.push_back((uint16_t)codePoint);
+    }
+    return out;
+}
+
+static bool CheckInput(const std::string& input)
+{
+    std::vector<uint16_t> actual(input.size() + 1, 0xCDCD);
+    auto count    = Utf8ToUtf16(input.data(), (uint32_t)input.size(), actual.data());
+    auto expected = ReferenceDecode((const uint8_t*)input.data(), input.size());
+    auto matches  = (count == expected.size()) && (memcmp(actual.data(), expected.data(), count * 2) == 0);
+    CHECK(matches, "input of %zu bytes decoded to %u code units, expected %zu", input.size(), count, expected.size());
+    return matches;
+}
+
+// Small deterministic generator so failures reproduce..
+static uint32_t g_Random = 12345;
+static uint32_t NextRandom()
+{
+    g_Random = (g_Random * 1103515245u) + 12345u;
+    return g_Random >> 8;
+}
+
+static void Fuzz()
+{
+    // Valid sequences of every length, ill-formed ones the decoder has to split correctly, and ascii runs long
+    // enough to cross the vector width at every offset..
+    const std::string pieces[] = {
+        "a", "hello world, this is ascii text!", std::string(33, 'x'), "\xC3\xA9", "\xE6\x97\xA5\xE6\x9C\xAC", "\xF0\x9F\x98\x80", "\xEF\xBF\xBF", "\xF4\x8F\xBF\xBF",
+        "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xC0\xAF", "\xE0\x80\xAF", "\xF0\x9F\x98", "\x80", "\xFF", "\xE2\x82", "\xC2", "\xF5\x80",
+    };
+    const uint32_t pieceCount = sizeof(pieces) / sizeof(pieces[0]);
+
+    for (uint32_t iteration = 0; iteration < 200000; iteration++)
+    {
+        std::string input;
+        if (iteration & 1)
+        {
+            // Random bytes, mostly ascii..
+            auto length = NextRandom() % 120;
+            for (uint32_t i = 0; i < length; i++)
+                input.push_back((char)(((NextRandom() % 10) < 3) ? (NextRandom() & 0xFF) : (NextRandom() & 0x7F)));
+        }
+        else
+        {
+            auto count = NextRandom() % 12;
+            for (uint32_t i = 0; i < count; i++)
+                input += pieces[NextRandom() % pieceCount];
+        }
+        if (!CheckInput(input))
+            return;
+    }
+}
+
+static void Benchmark(const char* name, const std::string& input)
+{
+    std::vector<uint16_t> out(input.size());
+    const int32_t iterations = 50;
+    uint32_t count = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < iterations; i++)
+        count += Utf8ToUtf16(input.data(), (uint32_t)input.size(), out.data());
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+    printf("%s: %.1f MB/s (%u code units)\n", name, (double)input.size() / seconds / 1e6, count / iterations);
+}
+
+int main()
+{
+    CheckInput("");
+    Fuzz();
+
+    std::string ascii;
+    std::string mixed;
+    while (ascii.size() < (1 << 20))
+    {
+        ascii += "The quick brown fox jumps over the lazy dog. ";
+        mixed += "Quest reward: \xE6\x97\xA5\xE6\x9C\xAC caf\xC3\xA9 \xF0\x9F\x98\x80 ";
+    }
+    Benchmark("ascii", ascii);
+    Benchmark("mixed", mixed);
+    return TestResult();
+}